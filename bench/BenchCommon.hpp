@@ -0,0 +1,40 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+namespace WeppBench {
+// Every benchmark passes its results here so the measured work cannot be optimized away
+inline void Consume(const uint64_t _value) {
+  static volatile uint64_t sink = 0;
+  sink = sink + _value;
+}
+
+// Calls _func repeatedly for about _duration after a short warm up and prints the time per call
+template <typename F> inline double Run(const char *_name, F &&_func, const std::chrono::milliseconds &_duration = std::chrono::milliseconds(500)) {
+  using Clock = std::chrono::steady_clock;
+
+  for (size_t i = 0; i < 1000; i++) {
+    _func();
+  }
+
+  uint64_t calls = 0;
+  const Clock::time_point start = Clock::now();
+  Clock::time_point now = start;
+
+  // Checks the clock every batch so reading it does not dominate short operations
+  while (now - start < _duration) {
+    for (size_t i = 0; i < 256; i++) {
+      _func();
+    }
+
+    calls += 256;
+    now = Clock::now();
+  }
+
+  const double nanoseconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count() / calls;
+  std::printf("%-40s %10.1f ns/op %14.0f ops/s\n", _name, nanoseconds, 1e9 / nanoseconds);
+  return nanoseconds;
+}
+} // namespace WeppBench
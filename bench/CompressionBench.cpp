@@ -0,0 +1,121 @@
+#include "BenchCommon.hpp"
+#include "Wepp/FileHandling/Compression.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// Vocabulary shared by the generated assets, drawn at random so they repeat like real sources but not verbatim
+static const char *s_WORDS[] = {"user", "session", "item", "price", "title", "content", "header", "footer", "button", "value", "index", "config", "request", "response", "status", "render", "update", "visible", "selected", "container"};
+
+struct Asset {
+  const char *name;
+  std::vector<unsigned char> contents;
+};
+
+static std::string Word(std::mt19937 &_generator) {
+  return s_WORDS[_generator() % (sizeof(s_WORDS) / sizeof(s_WORDS[0]))];
+}
+
+static std::string Number(std::mt19937 &_generator) {
+  return std::to_string(_generator() % 10000);
+}
+
+static std::string Html(std::mt19937 &_generator) {
+  std::string output = "<!DOCTYPE html>\n<html lang=\"en\">\n<head><meta charset=\"utf-8\"><title>Catalogue</title></head>\n<body>\n";
+  while (output.size() < 32 * 1024) {
+    output += "  <div class=\"" + Word(_generator) + "-" + Word(_generator) + "\" id=\"" + Word(_generator) + Number(_generator) + "\">\n";
+    output += "    <a href=\"/" + Word(_generator) + "/" + Number(_generator) + "\">" + Word(_generator) + " " + Word(_generator) + "</a>\n";
+    output += "    <span class=\"" + Word(_generator) + "\">" + Number(_generator) + "." + Number(_generator) + "</span>\n  </div>\n";
+  }
+
+  return output + "</body>\n</html>\n";
+}
+
+static std::string Script(std::mt19937 &_generator) {
+  std::string output;
+  while (output.size() < 128 * 1024) {
+    const std::string name = Word(_generator) + Number(_generator);
+    output += "function " + name + "(" + Word(_generator) + ", " + Word(_generator) + ") {\n";
+    output += "  const " + Word(_generator) + " = document.getElementById('" + Word(_generator) + Number(_generator) + "');\n";
+    output += "  if (" + Word(_generator) + ".length > " + Number(_generator) + ") { return " + Word(_generator) + "." + Word(_generator) + "; }\n";
+    output += "  return " + name + ".call(this, " + Number(_generator) + ");\n}\n";
+  }
+
+  return output;
+}
+
+static std::string Style(std::mt19937 &_generator) {
+  std::string output;
+  while (output.size() < 24 * 1024) {
+    output += "." + Word(_generator) + "-" + Word(_generator) + " {\n  margin: " + Number(_generator) + "px;\n  color: #" + std::to_string(_generator() % 0xffffff) + ";\n  display: flex;\n}\n";
+  }
+
+  return output;
+}
+
+static std::string Json(std::mt19937 &_generator) {
+  std::string output = "[";
+  while (output.size() < 64 * 1024) {
+    output += "{\"" + Word(_generator) + "\":\"" + Word(_generator) + " " + Word(_generator) + "\",\"id\":" + Number(_generator) + ",\"" + Word(_generator) + "\":" + Number(_generator) + "." + Number(_generator) + ",\"" +
+              Word(_generator) + "\":true},";
+  }
+
+  output.back() = ']';
+  return output;
+}
+
+static Asset MakeAsset(const char *_name, const std::string &_text) {
+  return {_name, std::vector<unsigned char>(_text.begin(), _text.end())};
+}
+
+// The cache compresses each file once, so the encoder's cost is paid per file version and the size on every response
+static void BenchAsset(const Asset &_asset) {
+  using Clock = std::chrono::steady_clock;
+
+  for (const Wepp::ContentEncoding encoding : {Wepp::ENCODING_IDENTITY, Wepp::ENCODING_GZIP, Wepp::ENCODING_BROTLI}) {
+    if (encoding == Wepp::ENCODING_IDENTITY) {
+      std::printf("%-10s %-9s %8zu bytes %6.1f%%\n", _asset.name, "identity", _asset.contents.size(), 100.0);
+      continue;
+    }
+
+    if (!Wepp::CompressionAvailable(encoding)) {
+      std::printf("%-10s %-9s not built in\n", _asset.name, Wepp::ContentEncodingName(encoding));
+      continue;
+    }
+
+    std::vector<unsigned char> output;
+    uint64_t calls = 0;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point now = start;
+
+    while (now - start < std::chrono::milliseconds(500)) {
+      Wepp::Compress(encoding, _asset.contents, output);
+      calls++;
+      now = Clock::now();
+    }
+
+    const double seconds = std::chrono::duration<double>(now - start).count() / calls;
+    std::printf("%-10s %-9s %8zu bytes %6.1f%% %10.1f us to compress %8.1f MB/s\n", _asset.name, Wepp::ContentEncodingName(encoding), output.size(), 100.0 * output.size() / _asset.contents.size(), seconds * 1e6,
+                _asset.contents.size() / seconds / 1e6);
+    WeppBench::Consume(output.size());
+  }
+}
+
+int main() {
+  std::mt19937 generator(11);
+
+  const Asset assets[] = {
+      MakeAsset("page.html", Html(generator)),
+      MakeAsset("app.js", Script(generator)),
+      MakeAsset("site.css", Style(generator)),
+      MakeAsset("data.json", Json(generator)),
+  };
+
+  for (const Asset &asset : assets) {
+    BenchAsset(asset);
+  }
+
+  return 0;
+}
@@ -0,0 +1,126 @@
+#include "LoopbackServer.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/Server.hpp"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+static const std::chrono::seconds s_DURATION(2);
+
+// One handshake on a fresh connection, offering _session when given. Closed with close_notify so the session
+// stays resumable on both ends.
+static bool Handshake(SSL_CTX *_clientCTX, const uint16_t _port, SSL_SESSION *_session, bool &_reused) {
+  const int fd = WeppTest::ConnectLoopback(_port);
+  if (fd < 0) {
+    return false;
+  }
+
+  SSL *ssl = SSL_new(_clientCTX);
+  SSL_set_fd(ssl, fd);
+  if (_session) {
+    SSL_set_session(ssl, _session);
+  }
+
+  const bool output = SSL_connect(ssl) == 1;
+  _reused = output && SSL_session_reused(ssl) == 1;
+
+  if (output) {
+    SSL_shutdown(ssl);
+  }
+
+  SSL_free(ssl);
+  close(fd);
+  return output;
+}
+
+// A session with a ticket or ID to offer. TLS 1.3 tickets arrive after the handshake, so a request is read through.
+static SSL_SESSION *FirstSession(SSL_CTX *_clientCTX, const uint16_t _port) {
+  const int fd = WeppTest::ConnectLoopback(_port);
+  if (fd < 0) {
+    return nullptr;
+  }
+
+  SSL *ssl = SSL_new(_clientCTX);
+  SSL_set_fd(ssl, fd);
+  SSL_SESSION *output = nullptr;
+
+  const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+  if (SSL_connect(ssl) == 1 && SSL_write(ssl, request.data(), (int)request.size()) == (int)request.size()) {
+    char buffer[4096];
+    while (SSL_read(ssl, buffer, sizeof(buffer)) > 0) {
+    }
+
+    output = SSL_get1_session(ssl);
+    SSL_shutdown(ssl);
+  }
+
+  SSL_free(ssl);
+  close(fd);
+  return output;
+}
+
+static void Measure(const char *_name, Wepp::Server &_server, const uint16_t _port, const int _version, const bool _tickets, const bool _resume) {
+  SSL_CTX *clientCTX = SSL_CTX_new(TLS_client_method());
+  SSL_CTX_set_verify(clientCTX, SSL_VERIFY_NONE, nullptr);
+  SSL_CTX_set_min_proto_version(clientCTX, _version);
+  SSL_CTX_set_max_proto_version(clientCTX, _version);
+  if (!_tickets) {
+    SSL_CTX_set_options(clientCTX, SSL_OP_NO_TICKET);
+  }
+
+  SSL_SESSION *session = _resume ? FirstSession(clientCTX, _port) : nullptr;
+  const Wepp::TLSSessionStats before = _server.GetTLSSessionStats();
+
+  uint64_t handshakes = 0;
+  uint64_t reused = 0;
+  bool wasReused;
+  const auto started = std::chrono::steady_clock::now();
+  auto now = started;
+
+  while (now - started < s_DURATION && Handshake(clientCTX, _port, session, wasReused)) {
+    handshakes++;
+    reused += wasReused ? 1 : 0;
+    now = std::chrono::steady_clock::now();
+  }
+
+  const Wepp::TLSSessionStats after = _server.GetTLSSessionStats();
+  const double seconds = std::chrono::duration<double>(now - started).count();
+
+  std::printf("%-28s %9.0f handshakes/s %7.1f us each   client resumed %llu/%llu, server full %llu resumed %llu\n", _name, handshakes / seconds, seconds * 1e6 / handshakes,
+              (unsigned long long)reused, (unsigned long long)handshakes, (unsigned long long)(after.fullHandshakes - before.fullHandshakes),
+              (unsigned long long)(after.resumedHandshakes - before.resumedHandshakes));
+
+  SSL_SESSION_free(session);
+  SSL_CTX_free(clientCTX);
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+  if (!WeppTest::WriteSelfSignedCertificate()) {
+    std::fprintf(stderr, "Cannot write the server certificate\n");
+    return 1;
+  }
+
+  Wepp::Server server(
+      [](const Wepp::RequestView &, Wepp::ResponseBuilder &_resp) {
+        _resp.AddHeader("Content-Length", "0");
+        return false;
+      },
+      nullptr, false, 2);
+
+  WeppTest::LoopbackServer loopback(server);
+  if (!loopback.WaitListening()) {
+    std::fprintf(stderr, "Server did not start\n");
+    return 1;
+  }
+
+  // Client and server share the machine, so each figure is the cost of both ends of a loopback handshake
+  Measure("TLS 1.3 full", server, loopback.GetPort(), TLS1_3_VERSION, true, false);
+  Measure("TLS 1.3 resumed, ticket", server, loopback.GetPort(), TLS1_3_VERSION, true, true);
+  Measure("TLS 1.2 full", server, loopback.GetPort(), TLS1_2_VERSION, true, false);
+  Measure("TLS 1.2 resumed, ticket", server, loopback.GetPort(), TLS1_2_VERSION, true, true);
+  Measure("TLS 1.2 resumed, session ID", server, loopback.GetPort(), TLS1_2_VERSION, false, true);
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+#include "BenchCommon.hpp"
+#include "Wepp/Server/ByteScan.hpp"
+#include "Wepp/Server/RequestParser.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+
+// A typical browser request, about 500 bytes
+static const std::string s_BROWSER_REQUEST = "GET /assets/app.js?v=3 HTTP/1.1\r\n"
+                                             "Host: localhost\r\n"
+                                             "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36\r\n"
+                                             "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+                                             "Accept-Encoding: gzip, deflate, br\r\n"
+                                             "Accept-Language: en-US,en;q=0.5\r\n"
+                                             "Connection: keep-alive\r\n"
+                                             "Referer: https://localhost/index.html\r\n"
+                                             "If-None-Match: \"0123456789abcdef0123456789abcdef\"\r\n"
+                                             "Cache-Control: max-age=0\r\n"
+                                             "\r\n";
+
+// Large cookies are the usual reason for multi-kilobyte header blocks
+static std::string LargeRequest() {
+  std::string output = s_BROWSER_REQUEST.substr(0, s_BROWSER_REQUEST.size() - 2);
+
+  for (int i = 0; i < 8; i++) {
+    output += "Cookie: session" + std::to_string(i) + "=" + std::string(480, 'a' + i) + "\r\n";
+  }
+
+  return output + "\r\n";
+}
+
+// Byte at a time, what the vectorized searches replace
+static size_t ScalarHeaderEnd(const unsigned char *_data, const size_t _size) {
+  for (size_t i = 0; i + 3 < _size; i++) {
+    if (_data[i] == '\r' && _data[i + 1] == '\n' && _data[i + 2] == '\r' && _data[i + 3] == '\n') {
+      return i;
+    }
+  }
+
+  return _size;
+}
+
+static size_t ScalarLines(const unsigned char *_data, const size_t _size) {
+  size_t output = 0;
+
+  for (size_t lineStart = 0; lineStart < _size;) {
+    size_t lineEnd = lineStart;
+    size_t colon = _size;
+
+    for (; lineEnd < _size && _data[lineEnd] != '\n'; lineEnd++) {
+      if (_data[lineEnd] == ':' && colon == _size) {
+        colon = lineEnd;
+      }
+    }
+
+    output += colon;
+    lineStart = lineEnd + 1;
+  }
+
+  return output;
+}
+
+static size_t VectorLines(const unsigned char *_data, const size_t _size) {
+  size_t output = 0;
+
+  for (size_t lineStart = 0; lineStart < _size;) {
+    size_t colon;
+    const size_t lineEnd = Wepp::FindLineEnd(_data, _size, lineStart, colon);
+
+    output += colon;
+    lineStart = lineEnd + 1;
+  }
+
+  return output;
+}
+
+static void BenchRequest(const char *_label, const std::string &_request) {
+  const unsigned char *data = (const unsigned char *)_request.data();
+  const size_t size = _request.size();
+
+  std::printf("\n%s, %zu bytes\n", _label, size);
+
+  WeppBench::Run("header end, scalar", [&]() { WeppBench::Consume(ScalarHeaderEnd(data, size)); });
+  WeppBench::Run("header end, FindHeaderEnd", [&]() { WeppBench::Consume(Wepp::FindHeaderEnd(data, size, 0)); });
+  WeppBench::Run("lines and colons, scalar", [&]() { WeppBench::Consume(ScalarLines(data, size)); });
+  WeppBench::Run("lines and colons, FindLineEnd", [&]() { WeppBench::Consume(VectorLines(data, size)); });
+
+  // The whole server-side parse: framing, then the view with its header index
+  Wepp::RequestParser parser;
+  Wepp::RequestView view;
+  std::vector<unsigned char> buffer(_request.begin(), _request.end());
+
+  const double nanoseconds = WeppBench::Run("RequestParser + RequestView", [&]() {
+    parser.Reset();
+    parser.Parse(buffer, 64 * 1024, 1024 * 1024);
+    view.Parse(buffer.data(), parser.RequestSize());
+    WeppBench::Consume(view.Headers().size());
+  });
+
+  std::printf("%-40s %10.2f GB/s\n", "parse throughput", size / nanoseconds);
+}
+
+int main() {
+#if defined(__AVX2__)
+  std::printf("ByteScan: AVX2\n");
+#elif defined(__SSE2__) || defined(_M_X64)
+  std::printf("ByteScan: SSE2\n");
+#else
+  std::printf("ByteScan: scalar\n");
+#endif // __AVX2__
+
+  BenchRequest("Browser request", s_BROWSER_REQUEST);
+  BenchRequest("Request with large cookies", LargeRequest());
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include "BenchCommon.hpp"
+#include "Wepp/Server/Router.hpp"
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Parsed requests for a spread of the registered routes, built once so only dispatch is timed
+struct Requests {
+  std::vector<std::string> raw;
+  std::vector<std::unique_ptr<Wepp::RequestView>> views;
+};
+
+static void BuildRequests(const size_t _routeCount, Requests &_requests) {
+  std::mt19937 generator(7);
+
+  _requests.raw.resize(256);
+  for (std::string &raw : _requests.raw) {
+    const size_t route = generator() % _routeCount;
+    raw = "GET /api/v1/resource" + std::to_string(route) + (generator() % 2 ? "/list" : "/12345") + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+    _requests.views.push_back(std::make_unique<Wepp::RequestView>());
+    _requests.views.back()->Parse((const unsigned char *)raw.data(), raw.size());
+  }
+}
+
+static void BenchRoutes(const size_t _resourceCount) {
+  Wepp::Router router;
+  size_t handled = 0;
+
+  const Wepp::WEPP_ROUTE_HANDLER handler = [&handled](const Wepp::RequestView &, const Wepp::RouteParameters &_parameters, Wepp::ResponseBuilder &) {
+    handled += _parameters.Size();
+    return false;
+  };
+
+  // Two routes per resource, one static and one with a parameter
+  for (size_t i = 0; i < _resourceCount; i++) {
+    router.Add(GParsing::GPARSING_GET, "/api/v1/resource" + std::to_string(i) + "/:id", handler);
+    router.Add(GParsing::GPARSING_GET, "/api/v1/resource" + std::to_string(i) + "/list", handler);
+  }
+
+  router.Compile();
+
+  Requests requests;
+  BuildRequests(_resourceCount, requests);
+
+  GParsing::HTTPResponse resp;
+  size_t next = 0;
+
+  const std::string name = "Dispatch, " + std::to_string(_resourceCount * 2) + " routes";
+  WeppBench::Run(name.c_str(), [&]() {
+    Wepp::ResponseBuilder builder(resp);
+    router.Dispatch(*requests.views[next++ % requests.views.size()], builder);
+  });
+
+  WeppBench::Consume(handled);
+}
+
+int main() {
+  // A trie walks the path once, so lookup time should barely move with the route count
+  for (const size_t resources : {5, 50, 500, 5000}) {
+    BenchRoutes(resources);
+  }
+
+  return 0;
+}
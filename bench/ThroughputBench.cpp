@@ -0,0 +1,95 @@
+#include "LoopbackServer.hpp"
+#include "Wepp/Server/HTTPChecks.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/Server.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static const std::chrono::seconds s_DURATION(2);
+
+// Keep-alive clients each sending requests back to back for s_DURATION, returns requests per second
+static double MeasureClients(const uint16_t _port, const size_t _clients, const std::string &_path) {
+  std::atomic<bool> stop = false;
+  std::atomic<uint64_t> completed = 0;
+  std::vector<std::thread> clients;
+
+  const std::string request = "GET " + _path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  const auto started = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < _clients; i++) {
+    clients.emplace_back([&stop, &completed, &request, _port]() {
+      std::string buffer, head, body;
+      uint64_t requests = 0;
+
+      // Reconnects whenever the server ends a connection, e.g. at its keep-alive request limit
+      while (!stop) {
+        const int fd = WeppTest::ConnectLoopback(_port);
+        if (fd < 0) {
+          break;
+        }
+
+        buffer.clear();
+        while (!stop && WeppTest::SendAll(fd, request) && WeppTest::ReadResponse(fd, buffer, head, body)) {
+          requests++;
+        }
+
+        close(fd);
+      }
+
+      completed += requests;
+    });
+  }
+
+  std::this_thread::sleep_for(s_DURATION);
+  stop = true;
+
+  for (std::thread &client : clients) {
+    client.join();
+  }
+
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  return completed / seconds;
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+  if (!WeppTest::WriteSelfSignedCertificate()) {
+    std::fprintf(stderr, "Cannot write the server certificate\n");
+    return 1;
+  }
+
+  const size_t workers = std::thread::hardware_concurrency() == 0 ? 4 : std::thread::hardware_concurrency();
+  const std::string small(1024, 's');
+  const std::string large(1024 * 1024, 'l');
+
+  Wepp::Server server(
+      [&small, &large](const Wepp::RequestView &_req, Wepp::ResponseBuilder &_resp) {
+        _resp.SetBody(std::string_view(_req.Path() == "/large" ? large : small));
+        _resp.SetCloseConnection(!Wepp::WantsKeepAlive(_req));
+        _resp.AddHeader("Content-Length", std::to_string(_resp.GetBodySize()));
+        return false;
+      },
+      nullptr, true, workers);
+
+  WeppTest::LoopbackServer loopback(server);
+  if (!loopback.WaitListening()) {
+    std::fprintf(stderr, "Server did not start\n");
+    return 1;
+  }
+
+  std::printf("%zu workers, one event loop\n", workers);
+
+  // Throughput should keep climbing with clients until the workers or the event loop are saturated
+  for (const size_t clients : {1, 2, 4, 8, 16, 32}) {
+    const double small = MeasureClients(loopback.GetPort(), clients, "/small");
+    const double large = MeasureClients(loopback.GetPort(), clients, "/large");
+    std::printf("%3zu clients: %10.0f req/s (1 KB) %8.0f req/s %8.1f MB/s (1 MB)\n", clients, small, large, large);
+  }
+
+  return 0;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+namespace Wepp {
+enum ContentEncoding {
+  ENCODING_IDENTITY,
+  ENCODING_GZIP,
+  ENCODING_BROTLI,
+  ENCODING_COUNT,
+};
+
+// Content-Encoding token, e.g. "gzip". Empty for identity.
+const char *ContentEncodingName(const ContentEncoding _encoding);
+
+// File extension of precompressed siblings, e.g. ".gz"
+const char *ContentEncodingExtension(const ContentEncoding _encoding);
+
+// False when the encoder was not found at build time
+bool CompressionAvailable(const ContentEncoding _encoding);
+
+// Text like formats worth compressing, decided by file extension
+bool IsCompressible(const std::filesystem::path &_path);
+
+bool Compress(const ContentEncoding _encoding, const std::vector<unsigned char> &_input, std::vector<unsigned char> &_output);
+} // namespace Wepp
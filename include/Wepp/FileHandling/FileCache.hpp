@@ -0,0 +1,151 @@
+#pragma once
+#include "Wepp/FileHandling/Compression.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Wepp {
+struct CachedFile {
+  // Normalized URI the entry is cached under
+  std::string key;
+  std::filesystem::path path;
+  uint64_t size;
+  // Nanoseconds since the Unix epoch
+  int64_t lastWriteTime;
+  // lastWriteTime in seconds, for Last-Modified
+  std::time_t lastModified;
+  uint64_t device;
+  uint64_t inode;
+
+  ContentEncoding encoding;
+  // Strong validator, distinct for every encoding of the same file version
+  std::string etag;
+  // Decided by the key's extension, so encoded siblings keep the original type
+  std::string_view contentType;
+  // Response header lines rendered once when the entry is loaded, see WEPP_CACHED_HEADERS_FUNC
+  std::string headers;
+
+  // Only filled for files up to the cache's maximum file size
+  bool contentsCached;
+  std::vector<unsigned char> contents;
+  // Kept open for files streamed from disk, so serving them resolves no path
+  std::shared_ptr<const FileHandle> handle;
+};
+
+// Renders the header lines that only depend on the cached file, stored in CachedFile::headers
+typedef std::function<std::string(const CachedFile &)> WEPP_CACHED_HEADERS_FUNC;
+
+struct FileCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t invalidations;
+  size_t entries;
+  size_t bytes;
+
+  double HitRate() const;
+};
+
+// Size bounded LRU cache of file metadata, contents and open descriptors under a root directory, keyed by normalized URI.
+// Files are opened relative to a descriptor held on the root and can never resolve outside it.
+// Entries are revalidated against the file's identity, size and modification time at most once per revalidate interval.
+// Sharded by key so concurrent workers rarely contend on the same lock.
+class FileCache {
+private:
+  struct Entry {
+    std::string key;
+    std::shared_ptr<const CachedFile> file;
+    std::chrono::steady_clock::time_point validated;
+
+    // Encoded representations of file, built on first request and dropped along with it
+    std::shared_ptr<const CachedFile> variants[ENCODING_COUNT];
+    bool variantsLoaded[ENCODING_COUNT];
+
+    // Set while one worker builds the variant, so concurrent first requests wait for it instead of compressing again
+    bool variantsLoading[ENCODING_COUNT];
+  };
+
+  struct Shard {
+    std::mutex mutex;
+    std::condition_variable variantBuilt;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    size_t bytes = 0;
+    size_t openFiles = 0;
+  };
+
+  static constexpr size_t s_SHARD_COUNT = 16;
+
+  const std::filesystem::path m_ROOT;
+  const size_t m_MAX_SHARD_BYTES;
+  const size_t m_MAX_FILE_SIZE;
+  const size_t m_MAX_SHARD_OPEN_FILES;
+  const std::chrono::milliseconds m_REVALIDATE_INTERVAL;
+  const WEPP_CACHED_HEADERS_FUNC m_renderHeaders;
+
+  // Opened on first use, the root may not exist yet when the cache is constructed
+  std::mutex m_rootMutex;
+  std::atomic<int> m_rootFD;
+
+  Shard m_shards[s_SHARD_COUNT];
+
+  std::atomic<uint64_t> m_hits;
+  std::atomic<uint64_t> m_misses;
+  std::atomic<uint64_t> m_evictions;
+  std::atomic<uint64_t> m_invalidations;
+
+public:
+  FileCache(const std::filesystem::path &_root, const size_t _maxBytes, const size_t _maxFileSize, const size_t _maxOpenFiles, const std::chrono::milliseconds &_revalidateInterval, const WEPP_CACHED_HEADERS_FUNC &_renderHeaders = nullptr);
+  FileCache(FileCache &&) = delete;
+  FileCache(const FileCache &) = delete;
+  FileCache &operator=(FileCache &&) = delete;
+  FileCache &operator=(const FileCache &) = delete;
+  ~FileCache();
+
+  // Returns nullptr when the URI does not name a regular file under the root
+  std::shared_ptr<const CachedFile> Get(const std::string_view &_uri);
+
+  // Encoded representation of a file returned by Get(). Prefers a precompressed sibling such as "index.html.br"
+  // and otherwise compresses cached contents once. Returns nullptr when no worthwhile variant exists.
+  std::shared_ptr<const CachedFile> GetVariant(const std::shared_ptr<const CachedFile> &_file, const ContentEncoding _encoding);
+
+  void Invalidate(const std::string &_uri);
+  void Clear();
+
+  FileCacheStats GetStats();
+
+private:
+  Shard &_ShardFor(const std::string &_key);
+
+  // -1 when the file is missing or outside the root
+  int _Open(const std::string &_relative);
+
+  // Takes ownership of _fd
+  std::shared_ptr<CachedFile> _Load(const std::string &_key, const std::filesystem::path &_path, const int _fd, const FileStatus &_status);
+  std::shared_ptr<CachedFile> _LoadVariant(const CachedFile &_file, const ContentEncoding _encoding);
+
+  void _Insert(Shard &_shard, const std::string &_key, const std::shared_ptr<const CachedFile> &_file);
+  void _Erase(Shard &_shard, std::list<Entry>::iterator _entry);
+  void _Evict(Shard &_shard);
+
+  static size_t _EntryBytes(const Entry &_entry);
+  static size_t _EntryOpenFiles(const Entry &_entry);
+};
+
+// Collapses duplicate separators and "." / ".." segments and strips any query or fragment.
+// Returns false if the path would escape above its root, or a segment holds a backslash or colon.
+bool NormalizeURIPath(const std::string_view &_uri, std::string &_normalized);
+} // namespace Wepp
@@ -1,10 +1,53 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
+#include <string>
 #include <vector>
 
 namespace Wepp {
 
 size_t FileSize(const std::filesystem::path &_filename);
 void ReadFile(const std::filesystem::path &_filename, std::vector<unsigned char> &_buffer);
+
+// Descriptor based access for streaming file bodies without loading them. Invalid descriptors are -1.
+int OpenFileDescriptor(const std::filesystem::path &_filename);
+void CloseFileDescriptor(const int _fd);
+bool FileDescriptorSize(const int _fd, uint64_t &_size);
+// Reads up to _size bytes at _offset without moving a shared file position. Returns -1 on error.
+int64_t ReadFileDescriptor(const int _fd, const uint64_t _offset, unsigned char *_buffer, const size_t _size);
+
+struct FileStatus {
+  uint64_t size;
+  // Nanoseconds since the Unix epoch
+  int64_t lastWriteTime;
+  // Device and inode, so a file replaced by rename is told apart from the one it replaced
+  uint64_t device;
+  uint64_t inode;
+};
+
+// False unless the descriptor refers to a regular file
+bool FileDescriptorStatus(const int _fd, FileStatus &_status);
+
+// Held open so files below it can be resolved without walking the full path. -1 where unsupported.
+int OpenDirectoryDescriptor(const std::filesystem::path &_directory);
+// Opens a relative path without leaving the directory, through ".." or symlinks, where the kernel supports
+// openat2() with RESOLVE_BENEATH. Elsewhere only the final component is kept from being a symlink.
+int OpenFileBeneath(const int _directoryFD, const std::string &_relative);
+
+// Closes its descriptor when the last owner lets go, so responses can keep streaming a file the cache has dropped
+class FileHandle {
+private:
+  const int m_FD;
+
+public:
+  explicit FileHandle(const int _fd);
+  FileHandle(FileHandle &&) = delete;
+  FileHandle(const FileHandle &) = delete;
+  FileHandle &operator=(FileHandle &&) = delete;
+  FileHandle &operator=(const FileHandle &) = delete;
+  ~FileHandle();
+
+  int Get() const;
+};
 } // namespace Wepp
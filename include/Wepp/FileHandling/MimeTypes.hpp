@@ -0,0 +1,9 @@
+#pragma once
+#include <filesystem>
+#include <string_view>
+
+namespace Wepp {
+// Content-Type for a file, decided by its extension. Falls back to "application/octet-stream".
+// The returned view points into a static table and stays valid for the program's lifetime.
+std::string_view MimeType(const std::filesystem::path &_path);
+} // namespace Wepp
@@ -0,0 +1,70 @@
+#pragma once
+#include "GNetworking/Socket.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+namespace Wepp {
+// Client address as IPv6, with IPv4 mapped into ::ffff:0:0/96
+struct PeerAddress {
+  uint64_t high;
+  uint64_t low;
+
+  bool operator==(const PeerAddress &_other) const {
+    return high == _other.high && low == _other.low;
+  }
+};
+
+struct PeerAddressHash {
+  size_t operator()(const PeerAddress &_address) const {
+    return (size_t)(_address.low * 0x9E3779B97F4A7C15ULL ^ _address.high);
+  }
+};
+
+// Caps open connections overall and per client address. Checked right after accept, before any TLS or
+// buffer state exists, so a flood of connections is turned away at the cost of an accept and a close.
+// Shared by all event loops. Per address counts are sharded so loops rarely contend.
+class AdmissionControl {
+private:
+  struct Shard {
+    std::mutex mutex;
+    std::unordered_map<PeerAddress, size_t, PeerAddressHash> connections;
+  };
+
+  static constexpr size_t s_SHARD_COUNT = 16;
+
+  size_t m_maxConnections;
+  size_t m_maxConnectionsPerAddress;
+
+  std::atomic<size_t> m_connections;
+  Shard m_shards[s_SHARD_COUNT];
+
+public:
+  AdmissionControl();
+  AdmissionControl(AdmissionControl &&) = delete;
+  AdmissionControl(const AdmissionControl &) = delete;
+  AdmissionControl &operator=(AdmissionControl &&) = delete;
+  AdmissionControl &operator=(const AdmissionControl &) = delete;
+  ~AdmissionControl() = default;
+
+  // 0 disables a limit. Not safe to change while connections are being admitted.
+  void SetMaxConnections(const size_t _maxConnections);
+  const size_t &GetMaxConnections();
+  void SetMaxConnectionsPerAddress(const size_t _maxConnections);
+  const size_t &GetMaxConnectionsPerAddress();
+
+  // Counts the connection if it is within the limits. _address is only looked up when a per address limit is set.
+  bool TryAdmit(const GNetworking::GNetworkingSocket _socket, PeerAddress &_address);
+  // For every connection TryAdmit() accepted, with the address it filled in
+  void Release(const PeerAddress &_address);
+
+  size_t GetConnectionCount() const;
+
+private:
+  Shard &_ShardFor(const PeerAddress &_address);
+};
+
+bool GetPeerAddress(const GNetworking::GNetworkingSocket _socket, PeerAddress &_address);
+} // namespace Wepp
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wepp {
+struct BufferPoolStats {
+  // Buffers handed out from the pool and ones that had to be allocated
+  uint64_t reused;
+  uint64_t allocated;
+  // Buffers freed instead of pooled because the pool was full or they had grown too large
+  uint64_t discarded;
+  size_t pooled;
+};
+
+// Recycles the storage of I/O buffers so connections do not allocate and free it for every request.
+// Idle connections hand their buffers back, so keep-alive connections hold no buffer memory between requests.
+// Not thread safe. Every thread that handles connections uses its own pool through Local().
+class BufferPool {
+private:
+  const size_t m_MAX_BUFFERS;
+  const size_t m_MAX_CAPACITY;
+
+  std::vector<std::vector<unsigned char>> m_buffers;
+  BufferPoolStats m_stats;
+
+public:
+  BufferPool(const size_t _maxBuffers, const size_t _maxCapacity);
+  BufferPool(BufferPool &&) = delete;
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(BufferPool &&) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  // Gives _buffer recycled storage of at least _capacity bytes when it has none yet. The contents are kept.
+  void Acquire(std::vector<unsigned char> &_buffer, const size_t _capacity);
+
+  // Takes the storage of an empty buffer back. Buffers still holding data are left alone.
+  void Release(std::vector<unsigned char> &_buffer);
+
+  BufferPoolStats GetStats() const;
+
+  // The calling thread's pool
+  static BufferPool &Local();
+};
+} // namespace Wepp
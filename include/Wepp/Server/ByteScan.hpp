@@ -0,0 +1,13 @@
+#pragma once
+#include <cstddef>
+
+namespace Wepp {
+// Vectorized searches over request bytes, SSE2 or AVX2 when the build targets them and scalar elsewhere
+
+// Offset of the first "\r\n\r\n" at or after _start, or _size when there is none
+size_t FindHeaderEnd(const unsigned char *_data, const size_t _size, size_t _start);
+
+// Offset of the first '\n' at or after _start, or _size when there is none. The same pass finds the first ':'
+// before it, stored in _colon (_size when the line has none), so a header line is split without a second scan.
+size_t FindLineEnd(const unsigned char *_data, const size_t _size, size_t _start, size_t &_colon);
+} // namespace Wepp
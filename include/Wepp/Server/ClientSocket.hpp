@@ -1,31 +1,129 @@
 #pragma once
+#include "Wepp/Server/AdmissionControl.hpp"
+#include "Wepp/Server/RequestParser.hpp"
+#include "Wepp/Server/StreamingBody.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <openssl/ssl.h>
+#include <utility>
+#include <vector>
 
 namespace Wepp {
+	enum ClientState {
+		// Waiting for the first byte to tell a TLS ClientHello (0x16) from plain HTTP
+		CLIENT_DETECTING,
+		// Resumable SSL_accept, driven by WANT_READ/WANT_WRITE readiness
+		CLIENT_HANDSHAKING,
+		CLIENT_ACTIVE,
+		// The event loop closes and frees the socket once the owning worker hands it back
+		CLIENT_CLOSING,
+	};
+
+	// What the connection is waiting for when its deadline passes
+	enum ClientTimeout {
+		TIMEOUT_HANDSHAKE,
+		TIMEOUT_REQUEST_HEADER,
+		TIMEOUT_REQUEST_BODY,
+		TIMEOUT_IDLE,
+		TIMEOUT_WRITE,
+	};
+
+	// The fields the event loop checks for every readiness event and expired deadline come first, so with the connection
+	// table's slot header they share one cache line. Buffers, parser state and statistics follow.
+	// Owned by exactly one thread at a time: the event loop while the socket is armed, or the single
+	// worker it was dispatched to until that worker reports it complete. No locking is needed for I/O.
 	struct ClientSocket
 	{
 		bool encrypted;
 		SSL* socket;
+		// Set by the connection table. Identifies this connection to the event loop and workers.
+		uint64_t handle;
+
+		ClientState state;
+		// Readiness to re-arm with when the owning worker hands the socket back
+		uint32_t interest;
+		// Only touched by the event loop. Set while a worker owns the socket.
+		bool dispatched;
+
+		// Only touched by the event loop. Recomputed whenever the socket is handed back to it.
+		ClientTimeout deadlineReason;
+		std::chrono::steady_clock::time_point deadline;
+		// Earliest expiry queued in the loop's timer wheel, unset when none is
+		std::chrono::steady_clock::time_point timerExpiry;
+
+		// Received bytes not yet consumed as a complete request. May hold several pipelined requests.
+		std::vector<unsigned char> recvBuffer;
+		// Framing progress of the request at the front of recvBuffer
+		RequestParser parser;
+		size_t requestsServed;
+		std::chrono::steady_clock::time_point lastActivity;
+		// First byte of the request still being received. Headers must be complete within a fixed time of it.
+		std::chrono::steady_clock::time_point requestStarted;
 
-		ClientSocket(SSL *const _socket = nullptr, const bool _encrypted = false) : encrypted(_encrypted), socket(_socket) {}
+		std::chrono::steady_clock::time_point connectedAt;
+		PeerAddress peer;
+		uint64_t bytesReceived;
+		uint64_t bytesSent;
 
-		// Shallow copy only
-		ClientSocket(const ClientSocket& _socket) = default;
-		ClientSocket& operator=(const ClientSocket& _socket) = default;
+		// Phase start times for the latency histograms
+		std::chrono::steady_clock::time_point handshakeStarted;
+		std::chrono::steady_clock::time_point sendStarted;
+
+		// Unsent response bytes, flushed when the socket becomes writable
+		std::vector<unsigned char> sendBuffer;
+		size_t sendOffset;
+		bool closeAfterSend;
+
+		// Streamed after sendBuffer drains
+		StreamingBody body;
+
+		ClientSocket(SSL *const _socket = nullptr, const bool _encrypted = false) : encrypted(_encrypted), socket(_socket), handle(0), state(CLIENT_DETECTING), interest(0), dispatched(false), deadlineReason(TIMEOUT_HANDSHAKE), requestsServed(0), lastActivity(std::chrono::steady_clock::now()), connectedAt(lastActivity), peer({0, 0}), bytesReceived(0), bytesSent(0), sendOffset(0), closeAfterSend(false) {}
+
+		ClientSocket(const ClientSocket& _socket) = delete;
+		ClientSocket& operator=(const ClientSocket& _socket) = delete;
 
 		// Move
-		ClientSocket(ClientSocket&& _socket) {
-			*this = _socket;
+		ClientSocket(ClientSocket&& _socket) : ClientSocket() {
+			*this = std::move(_socket);
 		}
 
 		ClientSocket& operator=(ClientSocket&& _socket) {
 			encrypted = _socket.encrypted;
 			socket = _socket.socket;
+			handle = _socket.handle;
+			state = _socket.state;
+			interest = _socket.interest;
+			dispatched = _socket.dispatched;
+			deadlineReason = _socket.deadlineReason;
+			deadline = _socket.deadline;
+			timerExpiry = _socket.timerExpiry;
+			recvBuffer = std::move(_socket.recvBuffer);
+			parser = _socket.parser;
+			requestsServed = _socket.requestsServed;
+			lastActivity = _socket.lastActivity;
+			requestStarted = _socket.requestStarted;
+			connectedAt = _socket.connectedAt;
+			peer = _socket.peer;
+			bytesReceived = _socket.bytesReceived;
+			bytesSent = _socket.bytesSent;
+			handshakeStarted = _socket.handshakeStarted;
+			sendStarted = _socket.sendStarted;
+			sendBuffer = std::move(_socket.sendBuffer);
+			sendOffset = _socket.sendOffset;
+			closeAfterSend = _socket.closeAfterSend;
+			body = std::move(_socket.body);
 
 			_socket.encrypted = false;
 			_socket.socket = nullptr;
+			_socket.parser.Reset();
+			_socket.sendOffset = 0;
 
 			return *this;
 		}
+
+		bool HasPendingSend() const {
+			return sendOffset < sendBuffer.size() || !body.Empty();
+		}
 	};
-} // namespace Wepp
\ No newline at end of file
+} // namespace Wepp
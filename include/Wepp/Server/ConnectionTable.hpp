@@ -0,0 +1,65 @@
+#pragma once
+#include "Wepp/Server/ClientSocket.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Wepp {
+// Slot index in the low 32 bits, slot generation in the high 32 bits. Stale handles never resolve.
+typedef uint64_t ConnectionHandle;
+
+// Connections in stable slots allocated in fixed size chunks, so pointers handed to workers survive growth.
+// Freed slots are reused from a free list and bump their generation, making insert, lookup and removal O(1).
+// Only the event loop thread may call into the table.
+class ConnectionTable {
+private:
+  // Line aligned with the handle check first, so validating a handle and reading the connection's leading fields
+  // costs one cache miss
+  struct alignas(64) Slot {
+    uint32_t generation = 1;
+    bool used = false;
+    ClientSocket client;
+  };
+
+  static constexpr size_t s_CHUNK_SIZE = 1024;
+
+  std::vector<std::unique_ptr<Slot[]>> m_chunks;
+  // Most recently freed last, so reuse favours slots that are still in cache
+  std::vector<uint32_t> m_freeSlots;
+  size_t m_size;
+
+public:
+  ConnectionTable();
+  ConnectionTable(ConnectionTable &&) = delete;
+  ConnectionTable(const ConnectionTable &) = delete;
+  ConnectionTable &operator=(ConnectionTable &&) = delete;
+  ConnectionTable &operator=(const ConnectionTable &) = delete;
+  ~ConnectionTable() = default;
+
+  ConnectionHandle Insert(ClientSocket &&_client);
+
+  // nullptr when the handle's connection has been removed
+  ClientSocket *Find(const ConnectionHandle _handle);
+
+  void Remove(const ConnectionHandle _handle);
+
+  size_t Size() const;
+  bool Empty() const;
+
+  // Visits every live connection. _func must not insert or remove.
+  template <typename F> void ForEach(F &&_func) {
+    for (size_t chunk = 0; chunk < m_chunks.size(); chunk++) {
+      for (size_t i = 0; i < s_CHUNK_SIZE; i++) {
+        Slot &slot = m_chunks[chunk][i];
+        if (slot.used) {
+          _func(slot.client);
+        }
+      }
+    }
+  }
+
+private:
+  Slot *_SlotFor(const ConnectionHandle _handle);
+};
+} // namespace Wepp
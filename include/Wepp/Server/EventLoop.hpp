@@ -0,0 +1,105 @@
+#pragma once
+#include "GNetworking/Socket.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#define WEPP_EVENTLOOP_EPOLL
+#endif // __linux__
+
+#ifndef _WIN32
+#include <poll.h>
+#endif // !_WIN32
+
+namespace Wepp {
+enum EventFlags : uint32_t {
+  EVENT_NONE = 0,
+  EVENT_READ = 1 << 0,
+  EVENT_WRITE = 1 << 1,
+  EVENT_HUP = 1 << 2,
+  EVENT_ERROR = 1 << 3,
+
+  // Registration only. Ignored by the poll() fallback, which is always level triggered.
+  EVENT_EDGE = 1 << 4,
+  // Registration only. The socket is disarmed after reporting once until Modify() is called.
+  // Registering with EVENT_NONE also disarms, including HUP and error reports.
+  EVENT_ONESHOT = 1 << 5,
+};
+
+struct Event {
+  // Caller chosen value registered with the socket
+  uint64_t token;
+  uint32_t events;
+};
+
+enum EventBackend {
+  BACKEND_POLL,
+  BACKEND_EPOLL,
+};
+
+// Readiness reactor. Sockets are registered once and Wait() only returns the ones that are ready.
+// Uses epoll where available and falls back to poll(). Only Wake() may be called from another thread.
+class EventLoop {
+private:
+  EventBackend m_backend;
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+  int m_epollFD;
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  GNetworking::GNetworkingSocket m_wakeReadSocket;
+  GNetworking::GNetworkingSocket m_wakeWriteSocket;
+
+  // poll() fallback state. Disarmed entries keep their slot but hold an invalid socket so poll() skips them.
+  std::vector<pollfd> m_pollSockets;
+  std::vector<GNetworking::GNetworkingSocket> m_pollRegistered;
+  std::vector<uint32_t> m_pollFlags;
+  std::vector<uint64_t> m_pollTokens;
+  std::unordered_map<GNetworking::GNetworkingSocket, size_t> m_pollIndices;
+
+public:
+  EventLoop();
+  EventLoop(EventLoop &&) = delete;
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(EventLoop &&) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+  ~EventLoop();
+
+  // _token is reported back in Event instead of the socket. UINT64_MAX is reserved.
+  bool Add(const GNetworking::GNetworkingSocket _socket, const uint32_t _events, const uint64_t _token);
+  bool Modify(const GNetworking::GNetworkingSocket _socket, const uint32_t _events, const uint64_t _token);
+  bool Remove(const GNetworking::GNetworkingSocket _socket);
+
+  // Blocks until at least one registered socket is ready, Wake() is called or the timeout expires.
+  size_t Wait(std::vector<Event> &_events, const int _timeoutMs);
+
+  void Wake();
+
+  EventBackend GetBackend() const;
+  const char *GetBackendName() const;
+
+private:
+  void _SetupWake();
+  void _DrainWake();
+};
+
+bool SetSocketNonBlocking(const GNetworking::GNetworkingSocket _socket);
+
+// True when the last failed socket call on this thread would have blocked
+bool SocketWouldBlock();
+
+enum AcceptError {
+  // Interrupted, or a connection that failed before it could be accepted. Others may still be queued.
+  ACCEPT_RETRY,
+  // Nothing left to accept
+  ACCEPT_DRAINED,
+  // Out of file descriptors, for the process or the whole system
+  ACCEPT_NO_DESCRIPTORS,
+  ACCEPT_FAILED,
+};
+
+// What the last failed accept on this thread means for draining the listener
+AcceptError LastAcceptError();
+} // namespace Wepp
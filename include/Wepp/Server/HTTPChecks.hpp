@@ -1,6 +1,40 @@
 #pragma once
-#include "GParsing/GParsing.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBody.hpp"
+#include <cstddef>
+#include <ctime>
+#include <string>
+#include <vector>
 
 namespace Wepp {
-bool HasHostHeader(const GParsing::HTTPRequest &_req);
+// Well-known headers are looked up through the view's index, so no check scans the header list
+bool HasHostHeader(const RequestView &_req);
+
+// HTTP/1.1 connections persist unless the client sends "Connection: close". HTTP/1.0 needs an explicit keep-alive.
+bool WantsKeepAlive(const RequestView &_req);
+
+// Weight the client's Accept-Encoding gives a content coding such as "gzip", from 0 (unacceptable) to 1
+double AcceptedEncodingQuality(const RequestView &_req, const char *_coding);
+
+// True when If-None-Match is present and lists "*" or the entity tag, compared weakly
+bool MatchesIfNoneMatch(const RequestView &_req, const std::string &_etag);
+
+// Conditional GET evaluation. If-None-Match takes precedence and If-Modified-Since is only used without it.
+// Only meaningful for GET and HEAD, other methods answer a matching If-None-Match with 412 instead.
+bool IsNotModified(const RequestView &_req, const std::string &_etag, const std::time_t _lastModified);
+
+enum RangeResult {
+  // No usable Range header, or an If-Range that no longer matches. Send the full representation.
+  RANGE_NONE,
+  RANGE_SATISFIABLE,
+  // 416 with "Content-Range: bytes */size"
+  RANGE_UNSATISFIABLE,
+};
+
+// Evaluates Range and If-Range against a representation of _size bytes, filling _ranges when satisfiable
+RangeResult EvaluateRange(const RequestView &_req, const uint64_t _size, const std::string &_etag, const std::time_t _lastModified, std::vector<ByteRange> &_ranges);
+
+// IMF-fixdate, e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+std::string FormatHTTPDate(const std::time_t _time);
+bool ParseHTTPDate(const std::string &_date, std::time_t &_time);
 } // namespace Wepp
@@ -0,0 +1,18 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include <string_view>
+
+namespace Wepp {
+struct HTTPStatus {
+  int code;
+  std::string_view reason;
+  // Complete "HTTP/1.1 <code> <reason>\r\n", ready to be copied into a response
+  std::string_view line;
+};
+
+// nullptr for codes outside the table
+const HTTPStatus *FindHTTPStatus(const int _code);
+
+// Sets an HTTP/1.1 status line with the standard reason phrase. Unknown codes get an empty reason.
+void SetResponseStatus(GParsing::HTTPResponse &_resp, const int _code);
+} // namespace Wepp
@@ -1,12 +1,20 @@
 #pragma once
-#include "GParsing/GParsing.hpp"
+#include "Wepp/FileHandling/FileCache.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include <string>
 
 namespace Wepp {
 void SetupHandling();
 
-bool HandleWeb(GParsing::HTTPRequest _req,
-                           GParsing::HTTPResponse &_resp,
-                           bool &_closeConnection);
+// Cache-Control value for files under a path prefix of data/, e.g. ("assets", "public, max-age=31536000, immutable").
+// The longest matching prefix wins and everything else revalidates with "no-cache". Call before the server starts.
+void SetCacheControl(const std::string &_pathPrefix, const std::string &_value);
 
-bool HandleWebPost(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp);
+bool HandleWeb(const RequestView &_req, ResponseBuilder &_resp);
+
+bool HandleWebPost(const RequestView &_req, ResponseBuilder &_resp);
+
+// Hit rate and occupancy of the cache HandleWeb serves data/ from
+FileCacheStats GetFileCacheStats();
 } // namespace Wepp
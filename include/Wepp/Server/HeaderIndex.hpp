@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace Wepp {
+// Request headers the server itself looks at
+enum KnownHeader {
+  HEADER_HOST,
+  HEADER_CONNECTION,
+  HEADER_ACCEPT_ENCODING,
+  HEADER_RANGE,
+  HEADER_IF_RANGE,
+  HEADER_IF_NONE_MATCH,
+  HEADER_IF_MODIFIED_SINCE,
+  HEADER_KNOWN_COUNT,
+};
+
+// HEADER_KNOWN_COUNT for any other name. Names are compared case-insensitively.
+KnownHeader ClassifyHeader(const std::string_view &_name);
+
+// Positions of the well-known headers in a request's header list, recorded while the list is built
+// so every later check is a direct lookup instead of another scan.
+class HeaderIndex {
+private:
+  static constexpr size_t s_NONE = (size_t)-1;
+
+  // First and last line carrying each name. Usually the same line, duplicates are rare.
+  size_t m_first[HEADER_KNOWN_COUNT];
+  size_t m_last[HEADER_KNOWN_COUNT];
+
+public:
+  HeaderIndex();
+
+  void Clear();
+  // Classifies the header at _position, which must be past every position recorded so far
+  void Record(const std::string_view &_name, const size_t _position);
+
+  bool Has(const KnownHeader _header) const;
+  size_t First(const KnownHeader _header) const;
+  size_t Last(const KnownHeader _header) const;
+};
+} // namespace Wepp
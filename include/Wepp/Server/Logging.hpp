@@ -0,0 +1,73 @@
+#pragma once
+#include "GLog/Log.hpp"
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+// Levels below this are compiled out entirely, arguments included
+#ifndef WEPP_LOG_COMPILED_LEVEL
+#define WEPP_LOG_COMPILED_LEVEL 0
+#endif // WEPP_LOG_COMPILED_LEVEL
+
+// The message pieces are only evaluated when the level passes, so filtered logs build nothing. Pieces are strings,
+// characters or integers written one after another, e.g. WEPP_LOG_DEBUG('[', socket, "]: Closed").
+#define WEPP_LOG(_level, ...)                                                                                          \
+  do {                                                                                                                 \
+    if ((int)(_level) >= WEPP_LOG_COMPILED_LEVEL && ::Wepp::LogEnabled(_level)) {                                      \
+      ::Wepp::LogMessage(_level, __VA_ARGS__);                                                                         \
+    }                                                                                                                  \
+  } while (0)
+
+#define WEPP_LOG_TRACE(...) WEPP_LOG(GLog::LOG_TRACE, __VA_ARGS__)
+#define WEPP_LOG_DEBUG(...) WEPP_LOG(GLog::LOG_DEBUG, __VA_ARGS__)
+#define WEPP_LOG_PRINT(...) WEPP_LOG(GLog::LOG_PRINT, __VA_ARGS__)
+#define WEPP_LOG_WARNING(...) WEPP_LOG(GLog::LOG_WARNING, __VA_ARGS__)
+#define WEPP_LOG_ERROR(...) WEPP_LOG(GLog::LOG_ERROR, __VA_ARGS__)
+
+namespace Wepp {
+// Compares against a mirror of the GLog threshold, without a call into GLog
+bool LogEnabled(const GLog::LogLevel _level);
+
+// Sets the GLog threshold as well. Use instead of GLog::SetLogLevel() so LogEnabled() stays in sync.
+void SetLogLevel(const GLog::LogLevel _level);
+GLog::LogLevel GetLogLevel();
+
+// Longest message kept, including the terminator. Longer ones are truncated.
+static constexpr size_t LOG_LINE_SIZE = 512;
+
+// A message formatted in place, so building it never allocates
+struct LogLine {
+  char text[LOG_LINE_SIZE];
+  size_t size = 0;
+
+  void Append(const std::string_view &_text);
+  void Append(const char _character);
+
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>> void Append(const T _value) {
+    const std::to_chars_result result = std::to_chars(text + size, text + LOG_LINE_SIZE - 1, _value);
+    if (result.ec == std::errc()) {
+      size = result.ptr - text;
+    }
+  }
+};
+
+// Writes through the async sink when it is running, directly to GLog otherwise
+void LogMessage(const GLog::LogLevel _level, const LogLine &_line);
+
+template <typename... T> void LogMessage(const GLog::LogLevel _level, const T &..._pieces) {
+  LogLine line;
+  (line.Append(_pieces), ...);
+  LogMessage(_level, line);
+}
+
+// Messages are copied into a preallocated ring of fixed size entries and written by a background thread.
+// Logging then never blocks or allocates: long messages are truncated and a full ring drops the message.
+// The ring is created by the first call and reused by later ones, which ignore _capacity.
+void StartAsyncLogging(const size_t _capacity = 4096);
+// Writes everything still queued before returning
+void StopAsyncLogging();
+
+uint64_t GetDroppedLogCount();
+} // namespace Wepp
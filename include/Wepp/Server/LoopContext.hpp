@@ -0,0 +1,42 @@
+#pragma once
+#include "GNetworking/Socket.hpp"
+#include "Wepp/Server/ConnectionTable.hpp"
+#include "Wepp/Server/EventLoop.hpp"
+#include "Wepp/Server/TimerWheel.hpp"
+#include "Wepp/Server/WorkQueue.hpp"
+#include "Wepp/Server/WorkerPool.hpp"
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace Wepp {
+// Everything one event loop owns. Loops only share the read-only TLS context and the TLS session cache,
+// so several can accept and serve connections on their own listeners without contending.
+struct LoopContext {
+  const size_t index;
+
+  GNetworking::GNetworkingSocket listener;
+  // Given up to accept and close a connection when out of descriptors, so the listener can still be drained
+  int reserveFD;
+  EventLoop eventLoop;
+  ConnectionTable connections;
+
+  // Workers hand connections back to the loop that owns them through this queue
+  WorkerPool workerPool;
+  WorkQueue<ConnectionHandle> completedSockets;
+
+  // Connection deadlines by handle, and the expired ones of the current pass
+  TimerWheel deadlines;
+  std::vector<ConnectionHandle> expired;
+
+  std::thread thread;
+
+  LoopContext(const size_t _index, const size_t _threadCount, const size_t _queueCapacity, const std::chrono::steady_clock::duration &_timerTick) : index(_index), listener(GNetworkingInvalidSocket), reserveFD(-1), workerPool(_threadCount, _queueCapacity), completedSockets(_queueCapacity), deadlines(_timerTick) {}
+
+  LoopContext(LoopContext &&) = delete;
+  LoopContext(const LoopContext &) = delete;
+  LoopContext &operator=(LoopContext &&) = delete;
+  LoopContext &operator=(const LoopContext &) = delete;
+};
+} // namespace Wepp
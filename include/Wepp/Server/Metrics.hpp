@@ -0,0 +1,80 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Wepp {
+enum MetricCounter {
+  COUNTER_CONNECTIONS_ACCEPTED,
+  COUNTER_CONNECTIONS_CLOSED,
+  // Turned away at accept by the connection limits
+  COUNTER_CONNECTIONS_REJECTED,
+  COUNTER_IDLE_TIMEOUTS,
+  COUNTER_HANDSHAKE_TIMEOUTS,
+  // Request headers or body not received in time
+  COUNTER_READ_TIMEOUTS,
+  // Response writes that made no progress in time
+  COUNTER_WRITE_TIMEOUTS,
+  COUNTER_HANDSHAKES_FAILED,
+  COUNTER_REQUESTS,
+  // Requests the parser refused with 400, 413 or 431
+  COUNTER_REQUESTS_REJECTED,
+  COUNTER_RESPONSES_1XX,
+  COUNTER_RESPONSES_2XX,
+  COUNTER_RESPONSES_3XX,
+  COUNTER_RESPONSES_4XX,
+  COUNTER_RESPONSES_5XX,
+  COUNTER_BYTES_RECEIVED,
+  COUNTER_BYTES_SENT,
+  COUNTER_COUNT,
+};
+
+enum MetricPhase {
+  // Setting up an accepted socket and registering it with its event loop
+  PHASE_ACCEPT,
+  // First TLS record to completed handshake, including client round trips
+  PHASE_HANDSHAKE,
+  // Framing the completed request and parsing it
+  PHASE_PARSE,
+  // Handler and post handler
+  PHASE_HANDLER,
+  // Response queued to fully written, including waits for a writable socket
+  PHASE_SEND,
+  PHASE_COUNT,
+};
+
+// Log-linear buckets in microseconds, in the style of HDR histograms: every power of two is split into
+// s_SUB_BUCKETS linear steps, so the relative error stays below 25% from 1us to over 30s.
+class LatencyHistogram {
+public:
+  static constexpr size_t s_SUB_BUCKET_BITS = 2;
+  static constexpr size_t s_SUB_BUCKETS = 1 << s_SUB_BUCKET_BITS;
+  static constexpr size_t s_MAX_EXPONENT = 25;
+  // The last bucket also takes everything beyond 2^(s_MAX_EXPONENT + 1) microseconds
+  static constexpr size_t s_BUCKET_COUNT = s_SUB_BUCKETS + (s_MAX_EXPONENT - s_SUB_BUCKET_BITS + 1) * s_SUB_BUCKETS;
+
+  uint64_t buckets[s_BUCKET_COUNT];
+  uint64_t count;
+  uint64_t sumMicros;
+
+  static size_t BucketIndex(const uint64_t _micros);
+  // Exclusive upper bound of a bucket in microseconds
+  static uint64_t BucketLimit(const size_t _index);
+};
+
+struct MetricsSnapshot {
+  uint64_t counters[COUNTER_COUNT];
+  LatencyHistogram phases[PHASE_COUNT];
+};
+
+// Process wide. Every thread updates its own cache line aligned shard with relaxed atomics,
+// so recording never contends. Reading sums the shards of all threads that ever recorded.
+void CountMetric(const MetricCounter _counter, const uint64_t _amount = 1);
+void RecordLatency(const MetricPhase _phase, const std::chrono::steady_clock::duration &_duration);
+
+MetricsSnapshot GetMetrics();
+
+// Appends all counters and histograms in the Prometheus text exposition format
+void RenderMetrics(std::string &_output);
+} // namespace Wepp
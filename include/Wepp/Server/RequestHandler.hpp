@@ -0,0 +1,20 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include <functional>
+
+namespace Wepp {
+// Called concurrently from every worker thread. Returning true for a request passes it on to the post handler.
+// Context is whatever the callable captures.
+typedef std::function<bool(const RequestView &_req, ResponseBuilder &_resp)> WEPP_REQUEST_HANDLER;
+
+// Original by-value handler signatures
+typedef bool (*WEPP_HANDLER_FUNC)(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp, bool &_closeConnection);
+typedef bool (*WEPP_POST_HANDLER_SUCCESS_FUNC)(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp);
+
+// Wrap the original signatures. The request is copied into a GParsing::HTTPRequest for every call,
+// so these only exist to keep older handlers working.
+WEPP_REQUEST_HANDLER AdaptHandler(const WEPP_HANDLER_FUNC _handler);
+WEPP_REQUEST_HANDLER AdaptPostHandler(const WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler);
+} // namespace Wepp
@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wepp {
+enum ParseStatus {
+  PARSE_INCOMPLETE,
+  PARSE_COMPLETE,
+  // ErrorStatus() holds the HTTP status to reject the request with
+  PARSE_ERROR,
+};
+
+// Resumable framing parser for one request at the front of a connection's receive buffer.
+// Each call only examines bytes appended since the last one. The header/body boundary is found once,
+// Content-Length bodies are waited for and chunked bodies are decoded in place as their bytes arrive.
+// A decoded request has its Transfer-Encoding line replaced by the Content-Length of the decoded body,
+// so it reads exactly like one sent with Content-Length.
+class RequestParser {
+private:
+  enum State {
+    PARSER_HEADERS,
+    PARSER_BODY,
+    PARSER_CHUNK_SIZE,
+    PARSER_CHUNK_DATA,
+    PARSER_CHUNK_DATA_END,
+    PARSER_TRAILERS,
+    PARSER_DONE,
+  };
+
+  State m_state;
+  // Raw bytes examined so far, including chunk framing that has been decoded away
+  size_t m_scanned;
+  size_t m_headerSize;
+  // End of the decoded body. Equal to m_scanned until chunk framing is removed.
+  size_t m_bodyEnd;
+  uint64_t m_remaining;
+  // The Transfer-Encoding line of a chunked request, including its line ending
+  size_t m_codingLineStart;
+  size_t m_codingLineSize;
+  int m_errorStatus;
+
+public:
+  RequestParser();
+
+  // _buffer must start at the request's first byte. Chunked bodies are rewritten in place.
+  ParseStatus Parse(std::vector<unsigned char> &_buffer, const size_t _maxHeaderSize, const uint64_t _maxBodySize);
+
+  // After PARSE_COMPLETE: the request as headers plus decoded body, and the raw bytes it occupied
+  size_t RequestSize() const;
+  size_t ConsumedSize() const;
+
+  int ErrorStatus() const;
+
+  // True once the header block of the current request has been received
+  bool HeadersComplete() const;
+
+  // Prepares for the next request on the connection
+  void Reset();
+
+private:
+  ParseStatus _ParseHeaders(const std::vector<unsigned char> &_buffer, const uint64_t _maxBodySize);
+  ParseStatus _ParseChunked(std::vector<unsigned char> &_buffer, const size_t _maxHeaderSize, const uint64_t _maxBodySize);
+  // Once the last chunk is decoded, swaps the Transfer-Encoding line for Content-Length
+  ParseStatus _ReplaceTransferEncoding(std::vector<unsigned char> &_buffer);
+
+  ParseStatus _Fail(const int _status);
+};
+} // namespace Wepp
@@ -0,0 +1,80 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include "Wepp/Server/HeaderIndex.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Wepp {
+struct RequestHeader {
+  std::string_view name;
+  // Without surrounding whitespace. Lists are not split, each line is one header.
+  std::string_view value;
+};
+
+// Read-only request backed by the bytes it was parsed from. Nothing is copied: every field is a view into
+// the receive buffer, so a view is only valid while the server handles the request it was passed with.
+class RequestView {
+private:
+  std::string_view m_raw;
+  GParsing::HTTPMethod m_method;
+  std::string_view m_methodName;
+  std::string_view m_target;
+  std::string_view m_version;
+  std::vector<RequestHeader> m_headers;
+  HeaderIndex m_index;
+  std::string_view m_body;
+
+public:
+  RequestView();
+
+  // _data holds one complete request as framed by RequestParser, with any chunked body already decoded.
+  // Returns false for a malformed request line or header. Reuses the header storage of earlier requests.
+  bool Parse(const unsigned char *_data, const size_t _size);
+
+  GParsing::HTTPMethod Method() const;
+  std::string_view MethodName() const;
+  // Request target as sent, including any query string
+  std::string_view Target() const;
+  // Target without scheme and authority, query string or fragment
+  std::string_view Path() const;
+  // Query string without the '?'
+  std::string_view Query() const;
+  std::string_view Version() const;
+  std::string_view Body() const;
+  // The whole request, headers and body
+  std::string_view Raw() const;
+
+  const std::vector<RequestHeader> &Headers() const;
+
+  bool Has(const KnownHeader _header) const;
+
+  // Every value of every line with that name, in request order
+  template <typename F> void ForEachValue(const KnownHeader _header, F &&_func) const {
+    if (!m_index.Has(_header)) {
+      return;
+    }
+
+    const size_t first = m_index.First(_header);
+    const size_t last = m_index.Last(_header);
+
+    for (size_t i = first; i <= last; i++) {
+      if (i != first && i != last && ClassifyHeader(m_headers[i].name) != _header) {
+        continue;
+      }
+
+      _func(m_headers[i].value);
+    }
+  }
+
+  // Values of every line with that name, joined with commas
+  bool Join(const KnownHeader _header, std::string &_value) const;
+
+  // Any header by name, case-insensitively. Empty when missing.
+  std::string_view Find(const std::string_view &_name) const;
+};
+
+// Empty for GPARSING_UNKNOWN
+std::string_view HTTPMethodName(const GParsing::HTTPMethod _method);
+} // namespace Wepp
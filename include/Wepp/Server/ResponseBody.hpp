@@ -0,0 +1,34 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Wepp {
+// Inclusive, as written in Range and Content-Range
+struct ByteRange {
+  uint64_t first;
+  uint64_t last;
+};
+
+// Inline framing when length is 0, otherwise a range of the file
+struct FileBodyPart {
+  std::string data;
+  uint64_t offset;
+  uint64_t length;
+};
+
+// A body the server streams straight from an open file (sendfile/kTLS where available) instead of
+// sending the response message. Only ever set through ResponseBuilder, never carried in the headers.
+struct FileBody {
+  std::shared_ptr<const FileHandle> file;
+  // Empty for the whole file
+  std::vector<FileBodyPart> parts;
+};
+
+// Turns a response holding a representation of _size bytes into a 206 for the given ranges. One range is sent
+// as-is with Content-Range, several as multipart/byteranges. Narrows _fileBody when given, _resp.message otherwise.
+void SetRangeBody(GParsing::HTTPResponse &_resp, FileBody *_fileBody, const uint64_t _size, const std::vector<ByteRange> &_ranges, const std::string &_contentType);
+} // namespace Wepp
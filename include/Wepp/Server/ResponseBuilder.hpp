@@ -0,0 +1,64 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
+#include "Wepp/Server/ResponseBody.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Wepp {
+// Fills the response the server sends for one request. Starts as "200 OK" with no headers or body,
+// and closing the connection afterwards unless the handler asks to keep it.
+class ResponseBuilder {
+private:
+  GParsing::HTTPResponse &m_response;
+  bool m_closeConnection;
+  FileBody m_fileBody;
+  std::shared_ptr<const std::vector<unsigned char>> m_sharedBody;
+  std::string m_rawHeaders;
+
+public:
+  explicit ResponseBuilder(GParsing::HTTPResponse &_response);
+  ResponseBuilder(ResponseBuilder &&) = delete;
+  ResponseBuilder(const ResponseBuilder &) = delete;
+  ResponseBuilder &operator=(ResponseBuilder &&) = delete;
+  ResponseBuilder &operator=(const ResponseBuilder &) = delete;
+
+  void SetStatus(const int _code);
+  int GetStatus() const;
+
+  void AddHeader(const std::string_view &_name, const std::string_view &_value);
+  // Replaces every earlier value of the header, compared case-insensitively
+  void SetHeader(const std::string_view &_name, const std::string_view &_value);
+  // Complete, already formatted "Name: value\r\n" lines, sent as they are ahead of the other headers.
+  // Kept apart from the header list, so nothing a handler puts there is ever written unescaped.
+  void AddRawHeaders(const std::string &_lines);
+  const std::string &GetRawHeaders() const;
+
+  void SetBody(std::vector<unsigned char> &&_body);
+  void SetBody(const std::vector<unsigned char> &_body);
+  void SetBody(const std::string_view &_body);
+  // Sent without copying, the buffer is kept alive until written. For bodies held by a cache.
+  void SetBody(const std::shared_ptr<const std::vector<unsigned char>> &_body);
+  size_t GetBodySize() const;
+  // Moves the shared body out for sending. Returns false when there is none.
+  bool TakeSharedBody(std::shared_ptr<const std::vector<unsigned char>> &_body);
+
+  // Streamed from an already open file by the server, which also sets Content-Length. There is no path
+  // overload: files come from FileCache, which only resolves them beneath its root.
+  void SetFileBody(const std::shared_ptr<const FileHandle> &_file);
+  // Moves the file body out for sending. Returns false when the body is held in memory.
+  bool TakeFileBody(FileBody &_body);
+  // Narrows the current body, held in memory or a file, to a 206 for _ranges
+  void SetRangeBody(const uint64_t _size, const std::vector<ByteRange> &_ranges, const std::string &_contentType);
+
+  void SetCloseConnection(const bool _close);
+  bool GetCloseConnection() const;
+
+  // For code still written against GParsing responses
+  GParsing::HTTPResponse &GetResponse();
+};
+} // namespace Wepp
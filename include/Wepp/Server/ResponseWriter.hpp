@@ -0,0 +1,15 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace Wepp {
+// Bytes AppendResponseHead() adds for _resp
+size_t ResponseHeadSize(const GParsing::HTTPResponse &_resp, const std::string_view &_rawHeaders = {});
+
+// Appends the status line and headers of _resp, formatted like HTTPResponse::CreateResponse(), but not the body.
+// The body is sent from its own storage instead of being copied in behind the headers. _rawHeaders holds complete,
+// already formatted "Name: value\r\n" lines written before the others as they are, see ResponseBuilder::AddRawHeaders().
+void AppendResponseHead(const GParsing::HTTPResponse &_resp, std::vector<unsigned char> &_buffer, const std::string_view &_rawHeaders = {});
+} // namespace Wepp
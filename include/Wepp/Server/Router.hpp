@@ -0,0 +1,108 @@
+#pragma once
+#include "GParsing/GParsing.hpp"
+#include "Wepp/Server/RequestHandler.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace Wepp {
+// Values captured by ":name" and "*name" segments of the matched route. Views into the request and the router.
+class RouteParameters {
+public:
+  static constexpr size_t s_MAX_PARAMETERS = 8;
+
+private:
+  std::array<std::pair<std::string_view, std::string_view>, s_MAX_PARAMETERS> m_parameters;
+  size_t m_count;
+
+public:
+  RouteParameters();
+
+  // Empty when the route has no parameter of that name
+  std::string_view Get(const std::string_view &_name) const;
+  size_t Size() const;
+
+  void Push(const std::string_view &_name, const std::string_view &_value);
+  void Truncate(const size_t _count);
+};
+
+typedef std::function<bool(const RequestView &_req, const RouteParameters &_parameters, ResponseBuilder &_resp)> WEPP_ROUTE_HANDLER;
+
+// Dispatches on method and path. Patterns are paths where a segment may be ":name", matching one non-empty
+// segment, or a final "*name", matching the rest of the path. Static text beats parameters, which beat wildcards.
+// Routes are added during setup and compiled into a radix trie, so a lookup walks the path once and allocates
+// nothing, however many routes there are. Dispatch() may then be called from any number of threads.
+class Router {
+private:
+  enum NodeKind {
+    NODE_STATIC,
+    NODE_PARAMETER,
+    NODE_WILDCARD,
+  };
+
+  static constexpr size_t s_NONE = (size_t)-1;
+  // One slot per GParsing::HTTPMethod. GPARSING_UNKNOWN holds routes for any method.
+  static constexpr size_t s_METHOD_SLOTS = GParsing::GPARSING_OPTIONS + 1;
+
+  struct Node {
+    NodeKind kind;
+    // Static bytes for NODE_STATIC, the parameter name otherwise
+    std::string text;
+    // Static children, ordered like their first bytes in childBytes. No two share a first byte.
+    std::vector<size_t> children;
+    std::string childBytes;
+    size_t parameterChild;
+    size_t wildcardChild;
+    std::array<size_t, s_METHOD_SLOTS> routes;
+  };
+
+  struct Route {
+    GParsing::HTTPMethod method;
+    std::string pattern;
+    WEPP_ROUTE_HANDLER handler;
+  };
+
+  std::vector<Node> m_nodes;
+  std::vector<Route> m_routes;
+  WEPP_REQUEST_HANDLER m_notFoundHandler;
+  bool m_compiled;
+
+public:
+  Router();
+  Router(Router &&) = delete;
+  Router(const Router &) = delete;
+  Router &operator=(Router &&) = delete;
+  Router &operator=(const Router &) = delete;
+
+  // GPARSING_UNKNOWN matches any method without a route of its own. Throws on malformed or conflicting patterns.
+  void Add(const GParsing::HTTPMethod _method, const std::string &_pattern, const WEPP_ROUTE_HANDLER &_handler);
+  void Add(const GParsing::HTTPMethod _method, const std::string &_pattern, const WEPP_REQUEST_HANDLER &_handler);
+  void AddRedirect(const std::string &_pattern, const std::string &_location, const int _status = 301);
+
+  // Answers paths without a route. The default is an empty 404.
+  void SetNotFoundHandler(const WEPP_REQUEST_HANDLER &_handler);
+
+  // Freezes the routes. Called by Handler(), adding routes afterwards throws.
+  void Compile();
+
+  bool Dispatch(const RequestView &_req, ResponseBuilder &_resp) const;
+
+  // Compiles and returns a handler for the server. The router has to outlive it.
+  WEPP_REQUEST_HANDLER Handler();
+
+private:
+  size_t _NewNode(const NodeKind _kind, const std::string &_text);
+  size_t _InsertStatic(size_t _node, std::string_view _text);
+  size_t _FindStaticChild(const Node &_node, const char _first) const;
+
+  bool _Match(const size_t _node, std::string_view _path, RouteParameters &_parameters, size_t &_matched) const;
+
+  void _RespondWithoutRoute(const RequestView &_req, ResponseBuilder &_resp, const int _status, const std::string &_allow) const;
+};
+} // namespace Wepp
@@ -1,36 +1,60 @@
 #pragma once
-#include "GLog/Log.hpp"
 #include "GNetworking/Socket.hpp"
 #include "GParsing/GParsing.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
+#include "Wepp/Server/AdmissionControl.hpp"
 #include "Wepp/Server/ClientSocket.hpp"
+#include "Wepp/Server/ConnectionTable.hpp"
+#include "Wepp/Server/EventLoop.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/LoopContext.hpp"
+#include "Wepp/Server/RequestHandler.hpp"
+#include "Wepp/Server/TLSSessions.hpp"
+#include "Wepp/Server/WorkQueue.hpp"
+#include "Wepp/Server/WorkerPool.hpp"
 #include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
-#include <mutex>
+#include <memory>
 #include <openssl/ssl.h>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Wepp {
 
-typedef bool (*WEPP_HANDLER_FUNC)(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp, bool &_closeConnection);
-typedef bool (*WEPP_POST_HANDLER_SUCCESS_FUNC)(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp);
-
 class Server {
 private:
   const bool m_supportHTTP;
   const size_t m_THREAD_COUNT;
 
-  GNetworking::GNetworkingSocket m_serverSocket;
-  std::vector<ClientSocket> m_clientSockets;
+  size_t m_loopCount;
+  bool m_pinLoopThreads;
+  std::vector<std::unique_ptr<LoopContext>> m_loops;
 
   SSL_CTX *m_sslCTX;
-
-  std::mutex m_mutex;
-  const std::atomic<WEPP_HANDLER_FUNC> m_handlerFunc;
-  const std::atomic<WEPP_POST_HANDLER_SUCCESS_FUNC> m_postHandlerFunc;
+  TLSSessionCache m_tlsSessions;
+
+  std::chrono::milliseconds m_keepAliveTimeout;
+  std::chrono::milliseconds m_handshakeTimeout;
+  std::chrono::milliseconds m_requestHeaderTimeout;
+  std::chrono::milliseconds m_requestBodyTimeout;
+  std::chrono::milliseconds m_writeTimeout;
+  AdmissionControl m_admission;
+  size_t m_maxKeepAliveRequests;
+  size_t m_maxRequestHeaderSize;
+  uint64_t m_maxRequestBodySize;
+  std::string m_metricsPath;
+
+  const WEPP_REQUEST_HANDLER m_handler;
+  const WEPP_REQUEST_HANDLER m_postHandler;
 
 public:
+  // The post handler runs after the handler accepts a request and may send an interim response ahead of the final one.
+  // It can be empty.
+  Server(const WEPP_REQUEST_HANDLER &_handler, const WEPP_REQUEST_HANDLER &_postHandler, const bool _supportNormalHTTP, const size_t &_threadCount = 4);
+  // Original handler signatures, wrapped with AdaptHandler() and AdaptPostHandler()
   Server(const WEPP_HANDLER_FUNC _handler, const WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler, const bool _supportNormalHTTP, const size_t &_threadCount = 4);
   Server(Server &&) = delete;
   Server(const Server &) = delete;
@@ -40,28 +64,126 @@ public:
 
   void Run(const std::string &_address, const uint16_t _port, std::atomic<bool> &_close);
 
-  GNetworking::GNetworkingSocket &GetServerSocket();
-  std::vector<ClientSocket> &GetClientSockets();
+  // Valid once Run() has set up the loops. Only safe to use from the owning loop's thread.
+  GNetworking::GNetworkingSocket &GetServerSocket(const size_t _loop = 0);
+  ConnectionTable &GetConnections(const size_t _loop = 0);
   const size_t &GetThreadCount();
 
+  // Independent event loops, each with its own SO_REUSEPORT listener, connections and share of the worker threads.
+  // More than one runs every loop on its own thread. Call before Run().
+  void SetEventLoopCount(const size_t _loops, const bool _pinThreads = false);
+  const size_t &GetEventLoopCount();
+
+  // Connection deadlines. They apply from the next time a connection returns to its event loop.
+  // Idle time after which a persistent connection is closed
+  void SetKeepAliveTimeout(const std::chrono::milliseconds &_timeout);
+  const std::chrono::milliseconds &GetKeepAliveTimeout();
+
+  // From accept until the first byte and, for TLS, the completed handshake
+  void SetHandshakeTimeout(const std::chrono::milliseconds &_timeout);
+  const std::chrono::milliseconds &GetHandshakeTimeout();
+
+  // From the first byte of a request until its whole header block, however steadily it trickles in
+  void SetRequestHeaderTimeout(const std::chrono::milliseconds &_timeout);
+  const std::chrono::milliseconds &GetRequestHeaderTimeout();
+
+  // Longest wait for more of a request body. Reset by every read, so large uploads are not cut off.
+  void SetRequestBodyTimeout(const std::chrono::milliseconds &_timeout);
+  const std::chrono::milliseconds &GetRequestBodyTimeout();
+
+  // Longest a queued response may make no progress because the client does not read it
+  void SetWriteTimeout(const std::chrono::milliseconds &_timeout);
+  const std::chrono::milliseconds &GetWriteTimeout();
+
+  // Open connections across all event loops. Further connections are closed as soon as they are accepted.
+  // 0, the default, is unlimited. Call before Run().
+  void SetMaxConnections(const size_t _maxConnections);
+  const size_t &GetMaxConnections();
+
+  // Open connections from one client address. 0, the default, is unlimited. Call before Run().
+  void SetMaxConnectionsPerAddress(const size_t _maxConnections);
+  const size_t &GetMaxConnectionsPerAddress();
+
+  // Requests served on one connection before it is closed. 0 disables persistent connections.
+  void SetMaxKeepAliveRequests(const size_t _maxRequests);
+  const size_t &GetMaxKeepAliveRequests();
+
+  // Largest request header block accepted. Larger requests are answered with 431 and the connection is closed.
+  void SetMaxRequestHeaderSize(const size_t _maxSize);
+  const size_t &GetMaxRequestHeaderSize();
+
+  // Largest request body accepted, Content-Length or decoded chunked. Larger requests are answered with 413.
+  void SetMaxRequestBodySize(const uint64_t _maxSize);
+  const uint64_t &GetMaxRequestBodySize();
+
+  // Session resumption hit/miss counters for the TLS context
+  TLSSessionStats GetTLSSessionStats();
+
+  // Request path answered with the Prometheus metrics of this process instead of calling the handler.
+  // Empty disables the endpoint, which is the default. Call before Run().
+  void SetMetricsPath(const std::string &_path);
+  const std::string &GetMetricsPath();
+
 private:
   void _Setup(const std::string &_address, const uint16_t _port);
 
-  void _MainLoop(std::atomic<bool> &_close);
+  void _SetupListener(LoopContext &_loop, const std::string &_address, const uint16_t _port, const bool _reusePort);
+
+  void _MainLoop(LoopContext &_loop, std::atomic<bool> &_close);
 
   void _Cleanup();
 
-  void _AcceptConnections();
+  void _AcceptConnections(LoopContext &_loop);
+  // Accepts and closes one queued connection using the reserve descriptor. False when there is nothing to shed.
+  bool _ShedConnection(LoopContext &_loop);
+
+  void _AcceptConnection(LoopContext &_loop, const GNetworking::GNetworkingSocket _socket);
+
+  void _DispatchClient(LoopContext &_loop, const ConnectionHandle _handle);
+
+  void _CompleteClient(LoopContext &_loop, const ConnectionHandle _handle);
+
+  void _RearmClients(LoopContext &_loop);
+
+  void _CloseConnection(LoopContext &_loop, const ConnectionHandle _handle);
+
+  // Picks the deadline for what the connection waits for next and queues it in the loop's timer wheel
+  void _ScheduleDeadline(LoopContext &_loop, ClientSocket &_client);
+
+  void _ExpireDeadlines(LoopContext &_loop);
+
+  void _HandleOnThread(ClientSocket &_client);
+
+  void _ServeClient(ClientSocket &_client);
+
+  bool _DetectProtocol(ClientSocket &_client);
+
+  bool _ContinueHandshake(ClientSocket &_client);
+
+  void _HandleRequest(ClientSocket &_client);
+
+  void _ProcessRequest(ClientSocket &_client, RequestView &_request, const unsigned char *_data, const size_t _size, const std::chrono::steady_clock::time_point &_parseStarted);
+
+  bool _IsMetricsRequest(const RequestView &_req) const;
 
-  void _HandleClients();
+  void _ServeMetrics(const RequestView &_req, GParsing::HTTPResponse &_resp, const bool _closeConnection);
 
-  void _CloseConnections();
+  void _RedirectToHTTPS(ClientSocket &_client, const RequestView &_req);
 
-  void _HandleOnThread(const ClientSocket&_client, WEPP_HANDLER_FUNC _handler, WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler);
+  void _RejectRequest(ClientSocket &_client, const int _status);
 
-  size_t _FindReadSize(const ClientSocket&_client);
+  // Appends one read to the client's receive buffer. _read is 0 when nothing was available.
+  bool _ReadBuffer(ClientSocket &_client, size_t &_read);
+  // Queues the response without sending it. The body moves out of _resp. _rawHeaders are pre-rendered lines from the builder.
+  void _QueueResponse(ClientSocket &_client, GParsing::HTTPResponse &_resp, const bool _close, const std::string_view &_rawHeaders = {});
+  bool _FlushSendBuffer(ClientSocket &_client);
+  // Writes the send buffer and the inline body parts behind it. _written is 0 when the socket would block.
+  bool _WriteGathered(ClientSocket &_client, size_t &_written);
+  void _ConsumeWritten(ClientSocket &_client, size_t _written, uint64_t &_bodySent);
 
-  bool _ReadBuffer(const ClientSocket&_client, std::vector<unsigned char> &_buffer);
-  bool _SendBuffer(const ClientSocket&_client, const std::vector<unsigned char> &_buffer, bool _close = true);
+  // Moves the file or shared body set through _builder, if any, onto the connection
+  bool _AttachFileBody(ClientSocket &_client, GParsing::HTTPResponse &_resp, ResponseBuilder &_builder);
+  bool _SendBodySegment(ClientSocket &_client, uint64_t &_sent);
+  void _AdvanceBodySegment(ClientSocket &_client, const uint64_t _sent);
 };
 } // namespace Wepp
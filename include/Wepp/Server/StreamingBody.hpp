@@ -0,0 +1,72 @@
+#pragma once
+#include "Wepp/FileHandling/FileIO.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Wepp {
+struct BodySegment {
+  // Inline bytes when fileLength is 0, otherwise a range of the body's file
+  std::vector<unsigned char> data;
+  // Inline bytes already sent
+  size_t dataOffset;
+  uint64_t fileOffset;
+  uint64_t fileLength;
+  // Inline bytes held elsewhere, such as a file cache entry, used instead of data when set
+  std::shared_ptr<const std::vector<unsigned char>> shared;
+
+  const unsigned char *Bytes() const {
+    return shared ? shared->data() : data.data();
+  }
+
+  size_t ByteCount() const {
+    return shared ? shared->size() : data.size();
+  }
+};
+
+// Response body sent after the headers in bounded chunks, so memory per connection does not grow with its size.
+// An ordered list of file ranges and small inline parts, enough for whole files, single ranges and multipart/byteranges.
+class StreamingBody {
+private:
+  std::shared_ptr<const FileHandle> m_file;
+  std::deque<BodySegment> m_segments;
+
+public:
+  StreamingBody();
+  StreamingBody(StreamingBody &&_body);
+  StreamingBody(const StreamingBody &) = delete;
+  StreamingBody &operator=(StreamingBody &&_body);
+  StreamingBody &operator=(const StreamingBody &) = delete;
+  ~StreamingBody();
+
+  // Takes ownership of the file descriptor, which is closed once the body completes
+  void Reset(const int _fileDescriptor);
+  // Shares a descriptor held elsewhere, such as by the file cache
+  void Reset(const std::shared_ptr<const FileHandle> &_file);
+
+  void AppendFileRange(const uint64_t _offset, const uint64_t _length);
+  // Takes the buffer's storage, so response bodies are never copied
+  void AppendData(std::vector<unsigned char> &&_data);
+  void AppendData(const std::string &_data);
+  // Sends the bytes in place, kept alive by the segment until written
+  void AppendData(const std::shared_ptr<const std::vector<unsigned char>> &_data);
+
+  bool Empty() const;
+  uint64_t Size() const;
+  int FileDescriptor() const;
+
+  BodySegment &Front();
+  // Inline data ready to be written along with whatever precedes it
+  bool FrontIsData() const;
+
+  size_t SegmentCount() const;
+  BodySegment &Segment(const size_t _index);
+  void PopFront();
+
+  // Drops the remaining segments and releases the file
+  void Clear();
+};
+} // namespace Wepp
@@ -0,0 +1,81 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <shared_mutex>
+
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+#include <openssl/hmac.h>
+#endif // OPENSSL_VERSION_NUMBER
+
+namespace Wepp {
+struct TLSSessionStats {
+  // Completed handshakes, split by whether a previous session was resumed
+  uint64_t fullHandshakes;
+  uint64_t resumedHandshakes;
+
+  // Server-side session ID cache, as reported by OpenSSL
+  long cacheHits;
+  long cacheMisses;
+  long cacheTimeouts;
+  long cacheSize;
+
+  // Stateless session tickets
+  uint64_t ticketsIssued;
+  uint64_t ticketsAccepted;
+  uint64_t ticketsRenewed;
+  uint64_t ticketsRejected;
+};
+
+// Session ID cache and stateless session tickets for an SSL_CTX.
+// Ticket keys rotate on a fixed lifetime; the previous key is still accepted and its tickets are renewed.
+class TLSSessionCache {
+private:
+  struct TicketKey {
+    unsigned char name[16];
+    unsigned char aesKey[32];
+    unsigned char hmacKey[32];
+    std::chrono::steady_clock::time_point created;
+    bool valid;
+  };
+
+  TicketKey m_currentKey;
+  TicketKey m_previousKey;
+  std::shared_mutex m_keyMutex;
+
+  SSL_CTX *m_sslCTX;
+
+  std::atomic<uint64_t> m_fullHandshakes;
+  std::atomic<uint64_t> m_resumedHandshakes;
+  std::atomic<uint64_t> m_ticketsIssued;
+  std::atomic<uint64_t> m_ticketsAccepted;
+  std::atomic<uint64_t> m_ticketsRenewed;
+  std::atomic<uint64_t> m_ticketsRejected;
+
+public:
+  TLSSessionCache();
+  TLSSessionCache(TLSSessionCache &&) = delete;
+  TLSSessionCache(const TLSSessionCache &) = delete;
+  TLSSessionCache &operator=(TLSSessionCache &&) = delete;
+  TLSSessionCache &operator=(const TLSSessionCache &) = delete;
+  ~TLSSessionCache();
+
+  void Configure(SSL_CTX *const _sslCTX);
+
+  void RecordHandshake(const SSL *const _ssl);
+
+  TLSSessionStats GetStats();
+
+private:
+  void _RotateKeys(const bool _onlyIfExpired);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  static int _TicketKeyCallback(SSL *_ssl, unsigned char _keyName[16], unsigned char *_iv, EVP_CIPHER_CTX *_cipherCTX, EVP_MAC_CTX *_macCTX, int _encrypt);
+#else
+  static int _TicketKeyCallback(SSL *_ssl, unsigned char _keyName[16], unsigned char *_iv, EVP_CIPHER_CTX *_cipherCTX, HMAC_CTX *_macCTX, int _encrypt);
+#endif // OPENSSL_VERSION_NUMBER
+};
+} // namespace Wepp
@@ -0,0 +1,51 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wepp {
+// Hierarchical timing wheel of one-shot deadlines keyed by caller chosen ids. Scheduling is O(1) and advancing
+// only touches the slots of the ticks that passed, however many timers are pending. Timers never fire early,
+// but may fire up to one tick late. There is no cancellation: callers ignore expiries they no longer care about.
+// Not thread safe.
+class TimerWheel {
+private:
+  struct Timer {
+    uint64_t id;
+    uint64_t expiry;
+  };
+
+  static constexpr size_t s_SLOT_BITS = 6;
+  static constexpr size_t s_SLOT_COUNT = 1 << s_SLOT_BITS;
+  static constexpr size_t s_LEVEL_COUNT = 4;
+  // Later deadlines are clamped to this many ticks ahead
+  static constexpr uint64_t s_MAX_TICKS = ((uint64_t)1 << (s_SLOT_BITS * s_LEVEL_COUNT)) - 1;
+
+  const std::chrono::steady_clock::duration m_TICK;
+  const std::chrono::steady_clock::time_point m_START;
+
+  // Last tick whose timers have fired
+  uint64_t m_current;
+  size_t m_size;
+  std::vector<Timer> m_slots[s_LEVEL_COUNT][s_SLOT_COUNT];
+
+public:
+  explicit TimerWheel(const std::chrono::steady_clock::duration &_tick);
+  TimerWheel(TimerWheel &&) = delete;
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(TimerWheel &&) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+  ~TimerWheel() = default;
+
+  void Schedule(const uint64_t _id, const std::chrono::steady_clock::time_point &_deadline);
+
+  // Appends the ids of every timer whose deadline has passed by _now
+  void Advance(const std::chrono::steady_clock::time_point &_now, std::vector<uint64_t> &_expired);
+
+  size_t Size() const;
+
+private:
+  void _Insert(const Timer &_timer);
+};
+} // namespace Wepp
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace Wepp {
+// Bounded lock-free multi-producer multi-consumer queue.
+// Each cell carries a sequence number so producers and consumers only contend on their own index.
+template <typename T> class WorkQueue {
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  static constexpr size_t s_CACHE_LINE = 64;
+
+  const size_t m_MASK;
+  std::unique_ptr<Cell[]> m_cells;
+
+  alignas(s_CACHE_LINE) std::atomic<size_t> m_enqueuePos;
+  alignas(s_CACHE_LINE) std::atomic<size_t> m_dequeuePos;
+
+public:
+  // Capacity is rounded up to the next power of two
+  explicit WorkQueue(const size_t _capacity) : m_MASK(_RoundCapacity(_capacity) - 1), m_cells(new Cell[m_MASK + 1]), m_enqueuePos(0), m_dequeuePos(0) {
+    for (size_t i = 0; i <= m_MASK; i++) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  WorkQueue(WorkQueue &&) = delete;
+  WorkQueue(const WorkQueue &) = delete;
+  WorkQueue &operator=(WorkQueue &&) = delete;
+  WorkQueue &operator=(const WorkQueue &) = delete;
+
+  bool TryPush(T _value) {
+    Cell *cell;
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+      cell = &m_cells[pos & m_MASK];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+
+      if (difference == 0) {
+        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        pos = m_enqueuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->value = std::move(_value);
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T &_value) {
+    Cell *cell;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+
+    while (true) {
+      cell = &m_cells[pos & m_MASK];
+      const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+      const intptr_t difference = (intptr_t)sequence - (intptr_t)(pos + 1);
+
+      if (difference == 0) {
+        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (difference < 0) {
+        return false;
+      } else {
+        pos = m_dequeuePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    _value = std::move(cell->value);
+    cell->sequence.store(pos + m_MASK + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Approximate, only meant for sleep/wake decisions
+  bool Empty() const {
+    return m_enqueuePos.load(std::memory_order_acquire) == m_dequeuePos.load(std::memory_order_acquire);
+  }
+
+private:
+  static size_t _RoundCapacity(const size_t _capacity) {
+    size_t output = 2;
+    while (output < _capacity) {
+      output <<= 1;
+    }
+
+    return output;
+  }
+};
+} // namespace Wepp
@@ -0,0 +1,50 @@
+#pragma once
+#include "Wepp/Server/ClientSocket.hpp"
+#include "Wepp/Server/WorkQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wepp {
+typedef std::function<void(ClientSocket &)> WEPP_WORKER_FUNC;
+
+// Long-lived worker threads fed from a lock-free queue of ready connections.
+// Idle workers sleep on a condition variable that is only touched when someone is actually sleeping.
+class WorkerPool {
+private:
+  const size_t m_THREAD_COUNT;
+
+  WorkQueue<ClientSocket *> m_queue;
+  std::vector<std::thread> m_threads;
+  WEPP_WORKER_FUNC m_workerFunc;
+
+  std::atomic<bool> m_stop;
+  std::atomic<size_t> m_pending;
+  std::atomic<size_t> m_sleeping;
+  std::mutex m_sleepMutex;
+  std::condition_variable m_sleepCondition;
+
+public:
+  WorkerPool(const size_t _threadCount, const size_t _queueCapacity);
+  WorkerPool(WorkerPool &&) = delete;
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(WorkerPool &&) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+  ~WorkerPool();
+
+  void Start(const WEPP_WORKER_FUNC &_workerFunc);
+  void Stop();
+
+  // Returns false when the queue is full
+  bool Submit(ClientSocket *const _client);
+
+  const size_t &GetThreadCount() const;
+
+private:
+  void _WorkerLoop();
+};
+} // namespace Wepp
@@ -1,44 +1,64 @@
 #include "GLog/Log.hpp"
+#include "Wepp/Server/Logging.hpp"
 #include "Wepp/Server/Server.hpp"
 #include "Wepp/Server/HandlerFunctions.hpp"
+#include "Wepp/Server/Router.hpp"
 #include <string>
 #include <cstdint>
 
 static const std::string PREFIX = "[Wepp]";
 static const std::string ADDRESS = "0.0.0.0";
 static uint16_t PORT = 8080;
+static size_t EVENT_LOOPS = 1;
 
 int main(int argc, char *argv[]) {
 #ifdef NDEBUG
-  GLog::SetLogLevel(GLog::LOG_WARNING);
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
 #else
-  GLog::SetLogLevel(GLog::LOG_TRACE);
+  Wepp::SetLogLevel(GLog::LOG_TRACE);
 #endif // NDEBUG
 
   GLog::SetLogPrefix(PREFIX);
+  Wepp::StartAsyncLogging();
 
-  if (argc == 2) {
+  if (argc >= 2) {
     try {
       PORT = std::stoi(argv[1]);
     }
     catch (const std::exception&) {
-      GLog::Log(GLog::LOG_WARNING, "Could not set port from command line arguments. Using default.");
+      WEPP_LOG_WARNING("Could not set port from command line arguments. Using default.");
+    }
+  }
+
+  if (argc >= 3) {
+    try {
+      EVENT_LOOPS = std::stoul(argv[2]);
+    }
+    catch (const std::exception&) {
+      WEPP_LOG_WARNING("Could not set event loop count from command line arguments. Using default.");
     }
   }
 
   Wepp::SetupHandling();
-  Wepp::Server server(Wepp::HandleWeb, Wepp::HandleWebPost, true);
+
+  Wepp::Router router;
+  router.Add(GParsing::GPARSING_UNKNOWN, "/*path", Wepp::HandleWeb);
+
+  Wepp::Server server(router.Handler(), Wepp::HandleWebPost, true);
+  server.SetEventLoopCount(EVENT_LOOPS, EVENT_LOOPS > 1);
 
   std::atomic<bool> close = false;
-  GLog::Log(GLog::LOG_PRINT, "Starting Wepp server on " + ADDRESS + ':' + std::to_string(PORT));
+  WEPP_LOG_PRINT("Starting Wepp server on ", ADDRESS, ':', PORT);
 
   try {
     server.Run(ADDRESS, PORT, close);
   }
   catch (const std::exception &e) {
-    GLog::Log(GLog::LOG_ERROR, e.what());
+    WEPP_LOG_ERROR(e.what());
+    Wepp::StopAsyncLogging();
     return 1;
   }
 
+  Wepp::StopAsyncLogging();
   return 0;
 }
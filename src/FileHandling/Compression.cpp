@@ -0,0 +1,119 @@
+#include "Wepp/FileHandling/Compression.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+#ifdef WEPP_ZLIB
+#include <zlib.h>
+#endif // WEPP_ZLIB
+
+#ifdef WEPP_BROTLI
+#include <brotli/encode.h>
+#endif // WEPP_BROTLI
+
+namespace Wepp {
+// Variants are compressed once per file version, so favour ratio over speed
+static constexpr int s_GZIP_LEVEL = 9;
+static constexpr int s_BROTLI_QUALITY = 9;
+
+static const char *const s_COMPRESSIBLE_EXTENSIONS[] = {
+    ".html", ".htm", ".css", ".js", ".mjs", ".json", ".map", ".svg", ".txt", ".xml", ".csv", ".md", ".wasm", ".ico",
+};
+
+const char *ContentEncodingName(const ContentEncoding _encoding) {
+  switch (_encoding) {
+  case ENCODING_GZIP:
+    return "gzip";
+  case ENCODING_BROTLI:
+    return "br";
+  default:
+    return "";
+  }
+}
+
+const char *ContentEncodingExtension(const ContentEncoding _encoding) {
+  switch (_encoding) {
+  case ENCODING_GZIP:
+    return ".gz";
+  case ENCODING_BROTLI:
+    return ".br";
+  default:
+    return "";
+  }
+}
+
+bool CompressionAvailable(const ContentEncoding _encoding) {
+  switch (_encoding) {
+#ifdef WEPP_ZLIB
+  case ENCODING_GZIP:
+    return true;
+#endif // WEPP_ZLIB
+#ifdef WEPP_BROTLI
+  case ENCODING_BROTLI:
+    return true;
+#endif // WEPP_BROTLI
+  default:
+    return false;
+  }
+}
+
+bool IsCompressible(const std::filesystem::path &_path) {
+  std::string extension = _path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char c) { return (char)std::tolower(c); });
+
+  for (const char *compressible : s_COMPRESSIBLE_EXTENSIONS) {
+    if (extension == compressible) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool Compress(const ContentEncoding _encoding, const std::vector<unsigned char> &_input, std::vector<unsigned char> &_output) {
+  _output.clear();
+
+#ifdef WEPP_ZLIB
+  if (_encoding == ENCODING_GZIP) {
+    z_stream stream = {};
+    // 16 + MAX_WBITS selects the gzip wrapper instead of raw zlib
+    if (deflateInit2(&stream, s_GZIP_LEVEL, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+      return false;
+    }
+
+    _output.resize(deflateBound(&stream, _input.size()));
+    stream.next_in = (Bytef *)_input.data();
+    stream.avail_in = _input.size();
+    stream.next_out = _output.data();
+    stream.avail_out = _output.size();
+
+    const int result = deflate(&stream, Z_FINISH);
+    _output.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return result == Z_STREAM_END;
+  }
+#endif // WEPP_ZLIB
+
+#ifdef WEPP_BROTLI
+  if (_encoding == ENCODING_BROTLI) {
+    size_t size = BrotliEncoderMaxCompressedSize(_input.size());
+    if (size == 0) {
+      return false;
+    }
+
+    _output.resize(size);
+    if (!BrotliEncoderCompress(s_BROTLI_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_GENERIC, _input.size(), _input.data(), &size, _output.data())) {
+      _output.clear();
+      return false;
+    }
+
+    _output.resize(size);
+    return true;
+  }
+#endif // WEPP_BROTLI
+
+  (void)_input;
+  return false;
+}
+} // namespace Wepp
@@ -0,0 +1,422 @@
+#include "Wepp/FileHandling/FileCache.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
+#include "Wepp/FileHandling/MimeTypes.hpp"
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+
+namespace Wepp {
+double FileCacheStats::HitRate() const {
+  const uint64_t lookups = hits + misses;
+  return lookups == 0 ? 0.0 : (double)hits / (double)lookups;
+}
+
+FileCache::FileCache(const std::filesystem::path &_root, const size_t _maxBytes, const size_t _maxFileSize, const size_t _maxOpenFiles, const std::chrono::milliseconds &_revalidateInterval, const WEPP_CACHED_HEADERS_FUNC &_renderHeaders)
+    : m_ROOT(std::filesystem::absolute(_root)), m_MAX_SHARD_BYTES(_maxBytes / s_SHARD_COUNT), m_MAX_FILE_SIZE(_maxFileSize), m_MAX_SHARD_OPEN_FILES(std::max<size_t>(_maxOpenFiles / s_SHARD_COUNT, 1)), m_REVALIDATE_INTERVAL(_revalidateInterval), m_renderHeaders(_renderHeaders), m_rootFD(-1), m_hits(0), m_misses(0), m_evictions(0), m_invalidations(0) {}
+
+FileCache::~FileCache() {
+  CloseFileDescriptor(m_rootFD.load());
+}
+
+std::shared_ptr<const CachedFile> FileCache::Get(const std::string_view &_uri) {
+  // Reused between lookups, so a cache hit allocates nothing
+  thread_local std::string key;
+  if (!NormalizeURIPath(_uri, key)) {
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  Shard &shard = _ShardFor(key);
+  const auto now = std::chrono::steady_clock::now();
+  std::shared_ptr<const CachedFile> existing;
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end()) {
+      shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+
+      if (now - found->second->validated < m_REVALIDATE_INTERVAL) {
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return found->second->file;
+      }
+
+      existing = found->second->file;
+    }
+  }
+
+  // Filesystem access happens outside the shard lock. One open beneath the root and one fstat.
+  const int fd = _Open(key);
+  FileStatus status;
+
+  if (fd < 0 || !FileDescriptorStatus(fd, status)) {
+    CloseFileDescriptor(fd);
+
+    if (existing) {
+      m_invalidations.fetch_add(1, std::memory_order_relaxed);
+      Invalidate(key);
+    }
+
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  if (existing && existing->size == status.size && existing->lastWriteTime == status.lastWriteTime && existing->device == status.device && existing->inode == status.inode) {
+    CloseFileDescriptor(fd);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(key);
+    if (found != shard.index.end() && found->second->file == existing) {
+      found->second->validated = now;
+    }
+
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return existing;
+  }
+
+  if (existing) {
+    m_invalidations.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+
+  std::shared_ptr<CachedFile> file = _Load(key, m_ROOT / key, fd, status);
+  if (!file) {
+    Invalidate(key);
+    return nullptr;
+  }
+
+  if (m_renderHeaders) {
+    file->headers = m_renderHeaders(*file);
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  _Insert(shard, key, file);
+  return file;
+}
+
+std::shared_ptr<const CachedFile> FileCache::GetVariant(const std::shared_ptr<const CachedFile> &_file, const ContentEncoding _encoding) {
+  if (!_file || _encoding == ENCODING_IDENTITY || _encoding >= ENCODING_COUNT) {
+    return _file;
+  }
+
+  Shard &shard = _ShardFor(_file->key);
+
+  {
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(_file->key);
+
+    while (found != shard.index.end() && found->second->file == _file && !found->second->variantsLoaded[_encoding] && found->second->variantsLoading[_encoding]) {
+      shard.variantBuilt.wait(lock);
+      found = shard.index.find(_file->key);
+    }
+
+    if (found != shard.index.end() && found->second->file == _file && found->second->variantsLoaded[_encoding]) {
+      m_hits.fetch_add(1, std::memory_order_relaxed);
+      return found->second->variants[_encoding];
+    }
+
+    // Claim the build. When the entry was evicted or replaced the variant is only built for this caller
+    if (found != shard.index.end() && found->second->file == _file) {
+      found->second->variantsLoading[_encoding] = true;
+    }
+  }
+
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+  std::shared_ptr<CachedFile> variant = _LoadVariant(*_file, _encoding);
+  if (variant && m_renderHeaders) {
+    variant->headers = m_renderHeaders(*variant);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.index.find(_file->key);
+
+    // Only attach to the version it was built from
+    if (found != shard.index.end() && found->second->file == _file && !found->second->variantsLoaded[_encoding]) {
+      found->second->variants[_encoding] = variant;
+      found->second->variantsLoaded[_encoding] = true;
+      found->second->variantsLoading[_encoding] = false;
+
+      if (variant) {
+        shard.bytes += sizeof(CachedFile) + variant->contents.size();
+        shard.openFiles += variant->handle ? 1 : 0;
+        _Evict(shard);
+      }
+    }
+  }
+
+  shard.variantBuilt.notify_all();
+  return variant;
+}
+
+void FileCache::Invalidate(const std::string &_uri) {
+  std::string key;
+  if (!NormalizeURIPath(_uri, key)) {
+    return;
+  }
+
+  Shard &shard = _ShardFor(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto found = shard.index.find(key);
+  if (found != shard.index.end()) {
+    _Erase(shard, found->second);
+  }
+}
+
+void FileCache::Clear() {
+  for (Shard &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.clear();
+    shard.index.clear();
+    shard.bytes = 0;
+    shard.openFiles = 0;
+  }
+}
+
+FileCacheStats FileCache::GetStats() {
+  FileCacheStats output = {};
+  output.hits = m_hits.load(std::memory_order_relaxed);
+  output.misses = m_misses.load(std::memory_order_relaxed);
+  output.evictions = m_evictions.load(std::memory_order_relaxed);
+  output.invalidations = m_invalidations.load(std::memory_order_relaxed);
+
+  for (Shard &shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    output.entries += shard.entries.size();
+    output.bytes += shard.bytes;
+  }
+
+  return output;
+}
+
+FileCache::Shard &FileCache::_ShardFor(const std::string &_key) {
+  return m_shards[std::hash<std::string>()(_key) % s_SHARD_COUNT];
+}
+
+#ifdef _WIN32
+// Resolves links and junctions on both sides, then compares. The root itself is not beneath itself.
+static bool IsBeneath(const std::filesystem::path &_root, const std::filesystem::path &_path) {
+  std::error_code error;
+  const std::filesystem::path root = std::filesystem::weakly_canonical(_root, error);
+  if (error) {
+    return false;
+  }
+
+  const std::filesystem::path path = std::filesystem::weakly_canonical(_path, error);
+  if (error) {
+    return false;
+  }
+
+  const std::filesystem::path relative = path.lexically_relative(root);
+  return !relative.empty() && !relative.is_absolute() && relative != "." && *relative.begin() != "..";
+}
+#endif // _WIN32
+
+int FileCache::_Open(const std::string &_relative) {
+  // The root itself is never served
+  if (_relative.empty()) {
+    return -1;
+  }
+
+  int root = m_rootFD.load(std::memory_order_acquire);
+  if (root < 0) {
+    std::lock_guard<std::mutex> lock(m_rootMutex);
+    root = m_rootFD.load(std::memory_order_relaxed);
+
+    if (root < 0) {
+      root = OpenDirectoryDescriptor(m_ROOT);
+      m_rootFD.store(root, std::memory_order_release);
+    }
+  }
+
+#ifdef _WIN32
+  // No directory descriptors, the normalized path is resolved instead and must still land beneath the root
+  const std::filesystem::path path = m_ROOT / _relative;
+  return IsBeneath(m_ROOT, path) ? OpenFileDescriptor(path) : -1;
+#else
+  // Nothing is served when the root cannot be held open, rather than resolving paths outside it
+  return root < 0 ? -1 : OpenFileBeneath(root, _relative);
+#endif // _WIN32
+}
+
+std::shared_ptr<CachedFile> FileCache::_Load(const std::string &_key, const std::filesystem::path &_path, const int _fd, const FileStatus &_status) {
+  auto output = std::make_shared<CachedFile>();
+  output->key = _key;
+  output->path = _path;
+  output->size = _status.size;
+  output->lastWriteTime = _status.lastWriteTime;
+  output->lastModified = (std::time_t)(_status.lastWriteTime / 1000000000);
+  output->device = _status.device;
+  output->inode = _status.inode;
+  output->encoding = ENCODING_IDENTITY;
+  output->contentType = MimeType(_key);
+  output->contentsCached = false;
+
+  char etag[64];
+  std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"", (unsigned long long)_status.size, (unsigned long long)_status.lastWriteTime);
+  output->etag = etag;
+
+  // Streamed from the descriptor, which is also what the status describes
+  if (_status.size > m_MAX_FILE_SIZE || _status.size > m_MAX_SHARD_BYTES) {
+    output->handle = std::make_shared<const FileHandle>(_fd);
+    return output;
+  }
+
+  output->contents.resize(_status.size);
+  size_t offset = 0;
+  while (offset < _status.size) {
+    const int64_t result = ReadFileDescriptor(_fd, offset, output->contents.data() + offset, _status.size - offset);
+    if (result <= 0) {
+      break;
+    }
+
+    offset += result;
+  }
+
+  CloseFileDescriptor(_fd);
+
+  if (offset != _status.size) {
+    return nullptr;
+  }
+
+  output->contentsCached = true;
+  return output;
+}
+
+std::shared_ptr<CachedFile> FileCache::_LoadVariant(const CachedFile &_file, const ContentEncoding _encoding) {
+  std::shared_ptr<CachedFile> output;
+
+  const std::string sibling = _file.key + ContentEncodingExtension(_encoding);
+  const int fd = _Open(sibling);
+  FileStatus status;
+
+  // Siblings older than the original are stale leftovers from a previous build
+  if (fd >= 0 && FileDescriptorStatus(fd, status) && status.lastWriteTime >= _file.lastWriteTime) {
+    output = _Load(_file.key, m_ROOT / sibling, fd, status);
+  } else {
+    CloseFileDescriptor(fd);
+  }
+
+  if (!output && _file.contentsCached && IsCompressible(_file.path) && CompressionAvailable(_encoding)) {
+    output = std::make_shared<CachedFile>();
+    output->key = _file.key;
+    output->path = _file.path;
+    output->lastWriteTime = _file.lastWriteTime;
+    output->device = _file.device;
+    output->inode = _file.inode;
+    output->contentType = _file.contentType;
+    output->contentsCached = true;
+
+    if (!Compress(_encoding, _file.contents, output->contents) || output->contents.size() >= _file.contents.size()) {
+      return nullptr;
+    }
+
+    output->size = output->contents.size();
+  }
+
+  if (!output) {
+    return nullptr;
+  }
+
+  output->encoding = _encoding;
+  output->lastModified = _file.lastModified;
+  output->etag = _file.etag;
+  output->etag.insert(output->etag.size() - 1, std::string("-") + ContentEncodingName(_encoding));
+  return output;
+}
+
+void FileCache::_Insert(Shard &_shard, const std::string &_key, const std::shared_ptr<const CachedFile> &_file) {
+  auto found = _shard.index.find(_key);
+  if (found != _shard.index.end()) {
+    _Erase(_shard, found->second);
+  }
+
+  _shard.entries.push_front({_key, _file, std::chrono::steady_clock::now(), {}, {}, {}});
+  _shard.index[_key] = _shard.entries.begin();
+  _shard.bytes += _EntryBytes(_shard.entries.front());
+  _shard.openFiles += _EntryOpenFiles(_shard.entries.front());
+
+  _Evict(_shard);
+}
+
+void FileCache::_Erase(Shard &_shard, std::list<Entry>::iterator _entry) {
+  _shard.bytes -= _EntryBytes(*_entry);
+  _shard.openFiles -= _EntryOpenFiles(*_entry);
+  _shard.index.erase(_entry->key);
+  _shard.entries.erase(_entry);
+}
+
+void FileCache::_Evict(Shard &_shard) {
+  // Never evicts the most recently used entry, which is the one just inserted or extended
+  while ((_shard.bytes > m_MAX_SHARD_BYTES || _shard.openFiles > m_MAX_SHARD_OPEN_FILES) && _shard.entries.size() > 1) {
+    _Erase(_shard, std::prev(_shard.entries.end()));
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+size_t FileCache::_EntryBytes(const Entry &_entry) {
+  // Metadata only entries still count so the number of entries stays bounded
+  size_t output = sizeof(Entry) + sizeof(CachedFile) + _entry.key.size() + _entry.file->contents.size();
+
+  for (const auto &variant : _entry.variants) {
+    if (variant) {
+      output += sizeof(CachedFile) + variant->contents.size();
+    }
+  }
+
+  return output;
+}
+
+size_t FileCache::_EntryOpenFiles(const Entry &_entry) {
+  size_t output = _entry.file->handle ? 1 : 0;
+
+  for (const auto &variant : _entry.variants) {
+    if (variant && variant->handle) {
+      output++;
+    }
+  }
+
+  return output;
+}
+
+bool NormalizeURIPath(const std::string_view &_uri, std::string &_normalized) {
+  const std::string_view path = _uri.substr(0, _uri.find_first_of("?#"));
+
+  // Built in place, ".." drops the last segment written so far
+  _normalized.clear();
+
+  for (size_t start = 0; start <= path.size();) {
+    size_t next = path.find('/', start);
+    if (next == std::string_view::npos) {
+      next = path.size();
+    }
+
+    const std::string_view segment = path.substr(start, next - start);
+    start = next + 1;
+
+    // On Windows a backslash separates and a colon names a drive or stream, neither is part of a file beneath the root
+    if (segment.find_first_of("\\:") != std::string_view::npos) {
+      return false;
+    }
+
+    if (segment == "..") {
+      if (_normalized.empty()) {
+        return false;
+      }
+
+      const size_t parent = _normalized.rfind('/');
+      _normalized.resize(parent == std::string::npos ? 0 : parent);
+    } else if (!segment.empty() && segment != ".") {
+      if (!_normalized.empty()) {
+        _normalized += '/';
+      }
+
+      _normalized += segment;
+    }
+  }
+
+  return true;
+}
+} // namespace Wepp
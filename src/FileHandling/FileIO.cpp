@@ -1,6 +1,26 @@
 #include "Wepp/FileHandling/FileIO.hpp"
+#include <cerrno>
 #include <fstream>
 
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#if defined(__linux__) && __has_include(<linux/openat2.h>)
+#include <linux/openat2.h>
+#include <sys/syscall.h>
+
+#ifdef __NR_openat2
+#define WEPP_FILEIO_OPENAT2
+#endif // __NR_openat2
+#endif // __linux__ && <linux/openat2.h>
+
 namespace Wepp {
 
 size_t FileSize(const std::filesystem::path &_filename) {
@@ -22,4 +42,130 @@ void ReadFile(const std::filesystem::path &_filename,
   file.read((char *)_buffer.data(), _buffer.size());
   file.close();
 }
+
+int OpenFileDescriptor(const std::filesystem::path &_filename) {
+#ifdef _WIN32
+  return _wopen(_filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+  return open(_filename.c_str(), O_RDONLY | O_CLOEXEC);
+#endif // _WIN32
+}
+
+void CloseFileDescriptor(const int _fd) {
+  if (_fd < 0) {
+    return;
+  }
+
+#ifdef _WIN32
+  _close(_fd);
+#else
+  close(_fd);
+#endif // _WIN32
+}
+
+bool FileDescriptorSize(const int _fd, uint64_t &_size) {
+#ifdef _WIN32
+  struct _stat64 info;
+  if (_fstat64(_fd, &info) != 0) {
+    return false;
+  }
+#else
+  struct stat info;
+  if (fstat(_fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    return false;
+  }
+#endif // _WIN32
+
+  _size = info.st_size;
+  return true;
+}
+
+int64_t ReadFileDescriptor(const int _fd, const uint64_t _offset, unsigned char *_buffer, const size_t _size) {
+#ifdef _WIN32
+  if (_lseeki64(_fd, _offset, SEEK_SET) < 0) {
+    return -1;
+  }
+
+  return _read(_fd, _buffer, (unsigned int)_size);
+#else
+  ssize_t output;
+  do {
+    output = pread(_fd, _buffer, _size, _offset);
+  } while (output < 0 && errno == EINTR);
+
+  return output;
+#endif // _WIN32
+}
+
+bool FileDescriptorStatus(const int _fd, FileStatus &_status) {
+#ifdef _WIN32
+  struct _stat64 info;
+  if (_fstat64(_fd, &info) != 0 || !(info.st_mode & _S_IFREG)) {
+    return false;
+  }
+
+  _status.lastWriteTime = (int64_t)info.st_mtime * 1000000000;
+#else
+  struct stat info;
+  if (fstat(_fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+    return false;
+  }
+
+#ifdef __APPLE__
+  _status.lastWriteTime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+  _status.lastWriteTime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#endif // __APPLE__
+#endif // _WIN32
+
+  _status.size = info.st_size;
+  _status.device = info.st_dev;
+  _status.inode = info.st_ino;
+  return true;
+}
+
+int OpenDirectoryDescriptor(const std::filesystem::path &_directory) {
+#ifdef _WIN32
+  return -1;
+#else
+  return open(_directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#endif // _WIN32
+}
+
+int OpenFileBeneath(const int _directoryFD, const std::string &_relative) {
+#ifdef _WIN32
+  return -1;
+#else
+  // Non-blocking so a FIFO placed in the directory cannot stall the caller. Regular files ignore the flag.
+  const int flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOCTTY;
+
+#ifdef WEPP_FILEIO_OPENAT2
+  open_how how = {};
+  how.flags = flags;
+  how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+
+  long output;
+  do {
+    output = syscall(__NR_openat2, _directoryFD, _relative.c_str(), &how, sizeof(how));
+  } while (output < 0 && errno == EINTR);
+
+  // Kernels before 5.6 lack openat2()
+  if (output >= 0 || errno != ENOSYS) {
+    return (int)output;
+  }
+#endif // WEPP_FILEIO_OPENAT2
+
+  return openat(_directoryFD, _relative.c_str(), flags | O_NOFOLLOW);
+#endif // _WIN32
+}
+
+FileHandle::FileHandle(const int _fd) : m_FD(_fd) {}
+
+FileHandle::~FileHandle() {
+  CloseFileDescriptor(m_FD);
+}
+
+int FileHandle::Get() const {
+  return m_FD;
+}
 } // namespace Wepp
@@ -0,0 +1,102 @@
+#include "Wepp/FileHandling/MimeTypes.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstddef>
+#include <string>
+
+namespace Wepp {
+struct MimeMapping {
+  std::string_view extension;
+  std::string_view type;
+};
+
+static constexpr std::string_view s_DEFAULT_MIME_TYPE = "application/octet-stream";
+
+// Sorted by extension for binary search, checked below
+static constexpr std::array<MimeMapping, 40> s_MIME_TYPES = {{
+    {".aac", "audio/aac"},
+    {".avif", "image/avif"},
+    {".bin", "application/octet-stream"},
+    {".bmp", "image/bmp"},
+    {".css", "text/css; charset=utf-8"},
+    {".csv", "text/csv; charset=utf-8"},
+    {".gif", "image/gif"},
+    {".gz", "application/gzip"},
+    {".htm", "text/html; charset=utf-8"},
+    {".html", "text/html; charset=utf-8"},
+    {".ico", "image/x-icon"},
+    {".jpeg", "image/jpeg"},
+    {".jpg", "image/jpeg"},
+    {".js", "text/javascript; charset=utf-8"},
+    {".json", "application/json"},
+    {".map", "application/json"},
+    {".md", "text/markdown; charset=utf-8"},
+    {".mjs", "text/javascript; charset=utf-8"},
+    {".mp3", "audio/mpeg"},
+    {".mp4", "video/mp4"},
+    {".oga", "audio/ogg"},
+    {".ogg", "audio/ogg"},
+    {".ogv", "video/ogg"},
+    {".otf", "font/otf"},
+    {".pdf", "application/pdf"},
+    {".png", "image/png"},
+    {".svg", "image/svg+xml"},
+    {".tar", "application/x-tar"},
+    {".ttf", "font/ttf"},
+    {".txt", "text/plain; charset=utf-8"},
+    {".wasm", "application/wasm"},
+    {".wav", "audio/wav"},
+    {".webm", "video/webm"},
+    {".webmanifest", "application/manifest+json"},
+    {".webp", "image/webp"},
+    {".woff", "font/woff"},
+    {".woff2", "font/woff2"},
+    {".xml", "application/xml"},
+    {".zip", "application/zip"},
+    {".zst", "application/zstd"},
+}};
+
+static constexpr bool IsSorted() {
+  for (size_t i = 1; i < s_MIME_TYPES.size(); i++) {
+    if (!(s_MIME_TYPES[i - 1].extension < s_MIME_TYPES[i].extension)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Anything longer than the longest extension in the table cannot match
+static constexpr size_t LongestExtension() {
+  size_t output = 0;
+  for (const MimeMapping &mapping : s_MIME_TYPES) {
+    output = mapping.extension.size() > output ? mapping.extension.size() : output;
+  }
+
+  return output;
+}
+
+static_assert(IsSorted(), "s_MIME_TYPES must be sorted by extension");
+
+std::string_view MimeType(const std::filesystem::path &_path) {
+  const std::string extension = _path.extension().string();
+  if (extension.empty() || extension.size() > LongestExtension()) {
+    return s_DEFAULT_MIME_TYPE;
+  }
+
+  char lowered[LongestExtension()];
+  for (size_t i = 0; i < extension.size(); i++) {
+    lowered[i] = (char)std::tolower((unsigned char)extension[i]);
+  }
+
+  const std::string_view key(lowered, extension.size());
+  const auto found = std::lower_bound(s_MIME_TYPES.begin(), s_MIME_TYPES.end(), key, [](const MimeMapping &_mapping, const std::string_view _key) { return _mapping.extension < _key; });
+
+  if (found == s_MIME_TYPES.end() || found->extension != key) {
+    return s_DEFAULT_MIME_TYPE;
+  }
+
+  return found->type;
+}
+} // namespace Wepp
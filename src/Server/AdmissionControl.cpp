@@ -0,0 +1,109 @@
+#include "Wepp/Server/AdmissionControl.hpp"
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif // _WIN32
+
+namespace Wepp {
+AdmissionControl::AdmissionControl() : m_maxConnections(0), m_maxConnectionsPerAddress(0), m_connections(0) {}
+
+void AdmissionControl::SetMaxConnections(const size_t _maxConnections) {
+  m_maxConnections = _maxConnections;
+}
+
+const size_t &AdmissionControl::GetMaxConnections() {
+  return m_maxConnections;
+}
+
+void AdmissionControl::SetMaxConnectionsPerAddress(const size_t _maxConnections) {
+  m_maxConnectionsPerAddress = _maxConnections;
+}
+
+const size_t &AdmissionControl::GetMaxConnectionsPerAddress() {
+  return m_maxConnectionsPerAddress;
+}
+
+bool AdmissionControl::TryAdmit(const GNetworking::GNetworkingSocket _socket, PeerAddress &_address) {
+  _address = {0, 0};
+
+  if (m_connections.fetch_add(1, std::memory_order_relaxed) >= m_maxConnections && m_maxConnections > 0) {
+    m_connections.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  if (m_maxConnectionsPerAddress == 0) {
+    return true;
+  }
+
+  if (!GetPeerAddress(_socket, _address)) {
+    m_connections.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  Shard &shard = _ShardFor(_address);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  size_t &connections = shard.connections[_address];
+  if (connections >= m_maxConnectionsPerAddress) {
+    m_connections.fetch_sub(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  connections++;
+  return true;
+}
+
+void AdmissionControl::Release(const PeerAddress &_address) {
+  m_connections.fetch_sub(1, std::memory_order_relaxed);
+
+  if (m_maxConnectionsPerAddress == 0) {
+    return;
+  }
+
+  Shard &shard = _ShardFor(_address);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto found = shard.connections.find(_address);
+  if (found != shard.connections.end() && --found->second == 0) {
+    // Addresses without connections take no memory, however many have connected before
+    shard.connections.erase(found);
+  }
+}
+
+size_t AdmissionControl::GetConnectionCount() const {
+  return m_connections.load(std::memory_order_relaxed);
+}
+
+AdmissionControl::Shard &AdmissionControl::_ShardFor(const PeerAddress &_address) {
+  return m_shards[PeerAddressHash()(_address) % s_SHARD_COUNT];
+}
+
+bool GetPeerAddress(const GNetworking::GNetworkingSocket _socket, PeerAddress &_address) {
+  sockaddr_storage storage;
+  socklen_t size = sizeof(storage);
+  unsigned char bytes[16] = {};
+
+  if (getpeername(_socket, (sockaddr *)&storage, &size) != 0) {
+    return false;
+  }
+
+  if (storage.ss_family == AF_INET) {
+    bytes[10] = 0xFF;
+    bytes[11] = 0xFF;
+    std::memcpy(bytes + 12, &((const sockaddr_in *)&storage)->sin_addr, 4);
+  } else if (storage.ss_family == AF_INET6) {
+    std::memcpy(bytes, &((const sockaddr_in6 *)&storage)->sin6_addr, 16);
+  } else {
+    return false;
+  }
+
+  std::memcpy(&_address.high, bytes, 8);
+  std::memcpy(&_address.low, bytes + 8, 8);
+  return true;
+}
+} // namespace Wepp
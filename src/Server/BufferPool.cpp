@@ -0,0 +1,55 @@
+#include "Wepp/Server/BufferPool.hpp"
+#include <utility>
+
+namespace Wepp {
+// Per thread limits. Larger buffers only show up for big request bodies and are not worth keeping.
+static constexpr size_t s_LOCAL_MAX_BUFFERS = 64;
+static constexpr size_t s_LOCAL_MAX_CAPACITY = 128 * 1024;
+
+BufferPool::BufferPool(const size_t _maxBuffers, const size_t _maxCapacity)
+    : m_MAX_BUFFERS(_maxBuffers), m_MAX_CAPACITY(_maxCapacity), m_stats() {
+  m_buffers.reserve(m_MAX_BUFFERS);
+}
+
+void BufferPool::Acquire(std::vector<unsigned char> &_buffer, const size_t _capacity) {
+  if (_buffer.capacity() >= _capacity) {
+    return;
+  }
+
+  if (_buffer.capacity() == 0 && !m_buffers.empty()) {
+    _buffer.swap(m_buffers.back());
+    m_buffers.pop_back();
+    m_stats.reused++;
+  } else {
+    m_stats.allocated++;
+  }
+
+  _buffer.reserve(_capacity);
+}
+
+void BufferPool::Release(std::vector<unsigned char> &_buffer) {
+  if (!_buffer.empty() || _buffer.capacity() == 0) {
+    return;
+  }
+
+  if (m_buffers.size() >= m_MAX_BUFFERS || _buffer.capacity() > m_MAX_CAPACITY) {
+    std::vector<unsigned char>().swap(_buffer);
+    m_stats.discarded++;
+    return;
+  }
+
+  m_buffers.emplace_back();
+  m_buffers.back().swap(_buffer);
+}
+
+BufferPoolStats BufferPool::GetStats() const {
+  BufferPoolStats stats = m_stats;
+  stats.pooled = m_buffers.size();
+  return stats;
+}
+
+BufferPool &BufferPool::Local() {
+  thread_local BufferPool pool(s_LOCAL_MAX_BUFFERS, s_LOCAL_MAX_CAPACITY);
+  return pool;
+}
+} // namespace Wepp
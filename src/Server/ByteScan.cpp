@@ -0,0 +1,129 @@
+#include "Wepp/Server/ByteScan.hpp"
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif // __AVX2__
+
+namespace Wepp {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+// _mask must not be 0
+static size_t LowestSetBit(uint32_t _mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (size_t)__builtin_ctz(_mask);
+#else
+  size_t output = 0;
+  while (!(_mask & 1)) {
+    _mask >>= 1;
+    output++;
+  }
+
+  return output;
+#endif // __GNUC__ || __clang__
+}
+
+// Bits of _colons below the lowest bit of _lines, all of them when _lines is 0
+static uint32_t ColonsBeforeLineEnd(const uint32_t _colons, const uint32_t _lines) {
+  return _lines == 0 ? _colons : _colons & ((_lines & (0u - _lines)) - 1);
+}
+#endif // __AVX2__ || __SSE2__ || _M_X64
+
+// Compares a whole vector of candidate positions per step against each of the four terminator bytes.
+size_t FindHeaderEnd(const unsigned char *_data, const size_t _size, size_t _start) {
+#if defined(__AVX2__)
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i lf = _mm256_set1_epi8('\n');
+
+  for (; _start + sizeof(__m256i) + 3 <= _size; _start += sizeof(__m256i)) {
+    const __m256i first = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(_data + _start)), cr);
+    const __m256i second = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(_data + _start + 1)), lf);
+    const __m256i third = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(_data + _start + 2)), cr);
+    const __m256i fourth = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(_data + _start + 3)), lf);
+    const uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(first, second), _mm256_and_si256(third, fourth)));
+
+    if (mask != 0) {
+      return _start + LowestSetBit(mask);
+    }
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i lf = _mm_set1_epi8('\n');
+
+  for (; _start + sizeof(__m128i) + 3 <= _size; _start += sizeof(__m128i)) {
+    const __m128i first = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(_data + _start)), cr);
+    const __m128i second = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(_data + _start + 1)), lf);
+    const __m128i third = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(_data + _start + 2)), cr);
+    const __m128i fourth = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(_data + _start + 3)), lf);
+    const uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(first, second), _mm_and_si128(third, fourth)));
+
+    if (mask != 0) {
+      return _start + LowestSetBit(mask);
+    }
+  }
+#endif // __AVX2__
+
+  // Remaining tail, or the whole buffer without SIMD
+  for (; _start + 3 < _size; _start++) {
+    if (_data[_start] == '\r' && _data[_start + 1] == '\n' && _data[_start + 2] == '\r' && _data[_start + 3] == '\n') {
+      return _start;
+    }
+  }
+
+  return _size;
+}
+
+// One compare per byte class and vector, the line feed mask bounds which colons count
+size_t FindLineEnd(const unsigned char *_data, const size_t _size, size_t _start, size_t &_colon) {
+  _colon = _size;
+
+#if defined(__AVX2__)
+  const __m256i lf = _mm256_set1_epi8('\n');
+  const __m256i separator = _mm256_set1_epi8(':');
+
+  for (; _start + sizeof(__m256i) <= _size; _start += sizeof(__m256i)) {
+    const __m256i block = _mm256_loadu_si256((const __m256i *)(_data + _start));
+    const uint32_t lines = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf));
+    const uint32_t colons = _colon == _size ? ColonsBeforeLineEnd((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, separator)), lines) : 0;
+
+    if (colons != 0) {
+      _colon = _start + LowestSetBit(colons);
+    }
+
+    if (lines != 0) {
+      return _start + LowestSetBit(lines);
+    }
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  const __m128i lf = _mm_set1_epi8('\n');
+  const __m128i separator = _mm_set1_epi8(':');
+
+  for (; _start + sizeof(__m128i) <= _size; _start += sizeof(__m128i)) {
+    const __m128i block = _mm_loadu_si128((const __m128i *)(_data + _start));
+    const uint32_t lines = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, lf));
+    const uint32_t colons = _colon == _size ? ColonsBeforeLineEnd((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, separator)), lines) : 0;
+
+    if (colons != 0) {
+      _colon = _start + LowestSetBit(colons);
+    }
+
+    if (lines != 0) {
+      return _start + LowestSetBit(lines);
+    }
+  }
+#endif // __AVX2__
+
+  for (; _start < _size; _start++) {
+    if (_data[_start] == '\n') {
+      return _start;
+    }
+
+    if (_data[_start] == ':' && _colon == _size) {
+      _colon = _start;
+    }
+  }
+
+  return _size;
+}
+} // namespace Wepp
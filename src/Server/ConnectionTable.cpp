@@ -0,0 +1,76 @@
+#include "Wepp/Server/ConnectionTable.hpp"
+#include <utility>
+
+namespace Wepp {
+// Generations stay below this so a handle can never collide with tokens reserved by the event loop
+static constexpr uint32_t s_MAX_GENERATION = 0x7FFFFFFF;
+
+ConnectionTable::ConnectionTable() : m_size(0) {}
+
+ConnectionHandle ConnectionTable::Insert(ClientSocket &&_client) {
+  if (m_freeSlots.empty()) {
+    const size_t first = m_chunks.size() * s_CHUNK_SIZE;
+    m_chunks.emplace_back(new Slot[s_CHUNK_SIZE]);
+
+    // Reversed so the lowest index is handed out first
+    for (size_t i = s_CHUNK_SIZE; i > 0; i--) {
+      m_freeSlots.push_back((uint32_t)(first + i - 1));
+    }
+  }
+
+  const uint32_t index = m_freeSlots.back();
+  m_freeSlots.pop_back();
+
+  Slot &slot = m_chunks[index / s_CHUNK_SIZE][index % s_CHUNK_SIZE];
+  slot.client = std::move(_client);
+  slot.used = true;
+  m_size++;
+
+  slot.client.handle = ((ConnectionHandle)slot.generation << 32) | index;
+  return slot.client.handle;
+}
+
+ClientSocket *ConnectionTable::Find(const ConnectionHandle _handle) {
+  Slot *slot = _SlotFor(_handle);
+  return slot ? &slot->client : nullptr;
+}
+
+void ConnectionTable::Remove(const ConnectionHandle _handle) {
+  Slot *slot = _SlotFor(_handle);
+  if (!slot) {
+    return;
+  }
+
+  // Releases the connection's buffers rather than keeping them for the slot's next owner
+  slot->client = ClientSocket();
+  slot->used = false;
+  slot->generation = slot->generation >= s_MAX_GENERATION ? 1 : slot->generation + 1;
+
+  m_freeSlots.push_back((uint32_t)(_handle & 0xFFFFFFFF));
+  m_size--;
+}
+
+size_t ConnectionTable::Size() const {
+  return m_size;
+}
+
+bool ConnectionTable::Empty() const {
+  return m_size == 0;
+}
+
+ConnectionTable::Slot *ConnectionTable::_SlotFor(const ConnectionHandle _handle) {
+  const size_t index = (size_t)(_handle & 0xFFFFFFFF);
+  const uint32_t generation = (uint32_t)(_handle >> 32);
+
+  if (index >= m_chunks.size() * s_CHUNK_SIZE) {
+    return nullptr;
+  }
+
+  Slot &slot = m_chunks[index / s_CHUNK_SIZE][index % s_CHUNK_SIZE];
+  if (!slot.used || slot.generation != generation) {
+    return nullptr;
+  }
+
+  return &slot;
+}
+} // namespace Wepp
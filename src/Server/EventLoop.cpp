@@ -0,0 +1,399 @@
+#include "Wepp/Server/EventLoop.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include <cerrno>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif // _WIN32
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif // WEPP_EVENTLOOP_EPOLL
+
+namespace Wepp {
+// Token of the internal wake handle
+static constexpr uint64_t s_WAKE_TOKEN = UINT64_MAX;
+
+#ifdef _WIN32
+// No portable self-pipe on Windows, so bound every wait instead
+static constexpr int s_MAX_WAIT_MS = 10;
+#endif // _WIN32
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+static uint32_t ToEpollEvents(const uint32_t _events) {
+  uint32_t output = 0;
+
+  if (_events & EVENT_READ) {
+    output |= EPOLLIN;
+  }
+
+  if (_events & EVENT_WRITE) {
+    output |= EPOLLOUT;
+  }
+
+  if (_events & EVENT_EDGE) {
+    output |= EPOLLET;
+  }
+
+  if (_events & EVENT_ONESHOT) {
+    output |= EPOLLONESHOT;
+  }
+
+  return output;
+}
+
+static uint32_t FromEpollEvents(const uint32_t _events) {
+  uint32_t output = EVENT_NONE;
+
+  if (_events & (EPOLLIN | EPOLLPRI)) {
+    output |= EVENT_READ;
+  }
+
+  if (_events & EPOLLOUT) {
+    output |= EVENT_WRITE;
+  }
+
+  if (_events & EPOLLHUP) {
+    output |= EVENT_HUP;
+  }
+
+  if (_events & EPOLLERR) {
+    output |= EVENT_ERROR;
+  }
+
+  return output;
+}
+#endif // WEPP_EVENTLOOP_EPOLL
+
+static short ToPollEvents(const uint32_t _events) {
+  short output = 0;
+
+  if (_events & EVENT_READ) {
+    output |= POLLIN;
+  }
+
+  if (_events & EVENT_WRITE) {
+    output |= POLLOUT;
+  }
+
+  return output;
+}
+
+static uint32_t FromPollEvents(const short _events) {
+  uint32_t output = EVENT_NONE;
+
+  if (_events & POLLIN) {
+    output |= EVENT_READ;
+  }
+
+  if (_events & POLLOUT) {
+    output |= EVENT_WRITE;
+  }
+
+  if (_events & POLLHUP) {
+    output |= EVENT_HUP;
+  }
+
+  if (_events & (POLLERR | POLLNVAL)) {
+    output |= EVENT_ERROR;
+  }
+
+  return output;
+}
+
+EventLoop::EventLoop()
+    : m_backend(BACKEND_POLL), m_wakeReadSocket(GNetworkingInvalidSocket),
+      m_wakeWriteSocket(GNetworkingInvalidSocket) {
+#ifdef WEPP_EVENTLOOP_EPOLL
+  m_epollFD = epoll_create1(EPOLL_CLOEXEC);
+
+  if (m_epollFD >= 0) {
+    m_backend = BACKEND_EPOLL;
+  } else {
+    WEPP_LOG_WARNING("epoll unavailable, falling back to poll(): ", errno);
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  _SetupWake();
+}
+
+EventLoop::~EventLoop() {
+#ifdef WEPP_EVENTLOOP_EPOLL
+  if (m_epollFD >= 0) {
+    close(m_epollFD);
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+#ifndef _WIN32
+  if (m_wakeReadSocket != GNetworkingInvalidSocket) {
+    close(m_wakeReadSocket);
+  }
+
+  if (m_wakeWriteSocket != GNetworkingInvalidSocket && m_wakeWriteSocket != m_wakeReadSocket) {
+    close(m_wakeWriteSocket);
+  }
+#endif // !_WIN32
+}
+
+bool EventLoop::Add(const GNetworking::GNetworkingSocket _socket, const uint32_t _events, const uint64_t _token) {
+#ifdef WEPP_EVENTLOOP_EPOLL
+  if (m_backend == BACKEND_EPOLL) {
+    epoll_event event = {};
+    event.events = ToEpollEvents(_events);
+    event.data.u64 = _token;
+    return epoll_ctl(m_epollFD, EPOLL_CTL_ADD, _socket, &event) == 0;
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  if (m_pollIndices.count(_socket) > 0) {
+    return false;
+  }
+
+  pollfd entry = {};
+  entry.fd = _events == EVENT_NONE ? GNetworkingInvalidSocket : _socket;
+  entry.events = ToPollEvents(_events);
+
+  m_pollIndices[_socket] = m_pollSockets.size();
+  m_pollSockets.push_back(entry);
+  m_pollRegistered.push_back(_socket);
+  m_pollFlags.push_back(_events);
+  m_pollTokens.push_back(_token);
+  return true;
+}
+
+bool EventLoop::Modify(const GNetworking::GNetworkingSocket _socket, const uint32_t _events, const uint64_t _token) {
+#ifdef WEPP_EVENTLOOP_EPOLL
+  if (m_backend == BACKEND_EPOLL) {
+    epoll_event event = {};
+    event.events = ToEpollEvents(_events);
+    event.data.u64 = _token;
+    return epoll_ctl(m_epollFD, EPOLL_CTL_MOD, _socket, &event) == 0;
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  auto index = m_pollIndices.find(_socket);
+  if (index == m_pollIndices.end()) {
+    return false;
+  }
+
+  m_pollSockets[index->second].fd = _events == EVENT_NONE ? GNetworkingInvalidSocket : _socket;
+  m_pollSockets[index->second].events = ToPollEvents(_events);
+  m_pollFlags[index->second] = _events;
+  m_pollTokens[index->second] = _token;
+  return true;
+}
+
+bool EventLoop::Remove(const GNetworking::GNetworkingSocket _socket) {
+#ifdef WEPP_EVENTLOOP_EPOLL
+  if (m_backend == BACKEND_EPOLL) {
+    return epoll_ctl(m_epollFD, EPOLL_CTL_DEL, _socket, nullptr) == 0;
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  auto index = m_pollIndices.find(_socket);
+  if (index == m_pollIndices.end()) {
+    return false;
+  }
+
+  // Swap with the last entry so removal stays O(1)
+  const size_t removed = index->second;
+  const size_t last = m_pollSockets.size() - 1;
+  if (removed != last) {
+    m_pollSockets[removed] = m_pollSockets[last];
+    m_pollRegistered[removed] = m_pollRegistered[last];
+    m_pollFlags[removed] = m_pollFlags[last];
+    m_pollTokens[removed] = m_pollTokens[last];
+    m_pollIndices[m_pollRegistered[removed]] = removed;
+  }
+
+  m_pollSockets.pop_back();
+  m_pollRegistered.pop_back();
+  m_pollFlags.pop_back();
+  m_pollTokens.pop_back();
+  m_pollIndices.erase(index);
+  return true;
+}
+
+size_t EventLoop::Wait(std::vector<Event> &_events, const int _timeoutMs) {
+  _events.clear();
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+  if (m_backend == BACKEND_EPOLL) {
+    constexpr int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+
+    const int count = epoll_wait(m_epollFD, events, MAX_EVENTS, _timeoutMs);
+    for (int i = 0; i < count; i++) {
+      if (events[i].data.u64 == s_WAKE_TOKEN) {
+        _DrainWake();
+        continue;
+      }
+
+      _events.push_back({events[i].data.u64, FromEpollEvents(events[i].events)});
+    }
+
+    return _events.size();
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+#ifdef _WIN32
+  const int timeout = (_timeoutMs < 0 || _timeoutMs > s_MAX_WAIT_MS) ? s_MAX_WAIT_MS : _timeoutMs;
+  if (m_pollSockets.empty()) {
+    Sleep(timeout);
+    return 0;
+  }
+
+  const int count = WSAPoll(m_pollSockets.data(), (ULONG)m_pollSockets.size(), timeout);
+#else
+  const int count = poll(m_pollSockets.data(), m_pollSockets.size(), _timeoutMs);
+#endif // _WIN32
+
+  if (count <= 0) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < m_pollSockets.size(); i++) {
+    if (m_pollSockets[i].revents == 0 || m_pollSockets[i].fd == GNetworkingInvalidSocket) {
+      continue;
+    }
+
+    if (m_pollTokens[i] == s_WAKE_TOKEN) {
+      _DrainWake();
+      continue;
+    }
+
+    _events.push_back({m_pollTokens[i], FromPollEvents(m_pollSockets[i].revents)});
+
+    if (m_pollFlags[i] & EVENT_ONESHOT) {
+      m_pollSockets[i].fd = GNetworkingInvalidSocket;
+    }
+  }
+
+  return _events.size();
+}
+
+void EventLoop::Wake() {
+#ifndef _WIN32
+  if (m_wakeWriteSocket == GNetworkingInvalidSocket) {
+    return;
+  }
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+  const uint64_t value = 1;
+  (void)!write(m_wakeWriteSocket, &value, sizeof(value));
+#else
+  const char value = 1;
+  (void)!write(m_wakeWriteSocket, &value, sizeof(value));
+#endif // WEPP_EVENTLOOP_EPOLL
+#endif // !_WIN32
+}
+
+EventBackend EventLoop::GetBackend() const {
+  return m_backend;
+}
+
+const char *EventLoop::GetBackendName() const {
+  switch (m_backend) {
+  case BACKEND_EPOLL:
+    return "epoll";
+  default:
+    return "poll";
+  }
+}
+
+void EventLoop::_SetupWake() {
+#ifndef _WIN32
+#ifdef WEPP_EVENTLOOP_EPOLL
+  m_wakeReadSocket = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  m_wakeWriteSocket = m_wakeReadSocket;
+#else
+  int pipeFDs[2];
+  if (pipe(pipeFDs) == 0) {
+    m_wakeReadSocket = pipeFDs[0];
+    m_wakeWriteSocket = pipeFDs[1];
+    SetSocketNonBlocking(m_wakeReadSocket);
+    SetSocketNonBlocking(m_wakeWriteSocket);
+  }
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  if (m_wakeReadSocket == GNetworkingInvalidSocket || !Add(m_wakeReadSocket, EVENT_READ, s_WAKE_TOKEN)) {
+    WEPP_LOG_WARNING("Could not create event loop wake handle");
+  }
+#endif // !_WIN32
+}
+
+void EventLoop::_DrainWake() {
+#ifndef _WIN32
+  char buffer[64];
+  while (read(m_wakeReadSocket, buffer, sizeof(buffer)) > 0) {
+  }
+#endif // !_WIN32
+}
+
+bool SetSocketNonBlocking(const GNetworking::GNetworkingSocket _socket) {
+#ifdef _WIN32
+  u_long mode = 1;
+  return ioctlsocket(_socket, FIONBIO, &mode) == 0;
+#else
+  const int flags = fcntl(_socket, F_GETFL, 0);
+  if (flags < 0) {
+    return false;
+  }
+
+  return fcntl(_socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif // _WIN32
+}
+
+bool SocketWouldBlock() {
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif // _WIN32
+}
+
+AcceptError LastAcceptError() {
+#ifdef _WIN32
+  switch (WSAGetLastError()) {
+  case WSAEWOULDBLOCK:
+    return ACCEPT_DRAINED;
+  case WSAEINTR:
+  case WSAECONNRESET:
+    return ACCEPT_RETRY;
+  case WSAEMFILE:
+    return ACCEPT_NO_DESCRIPTORS;
+  default:
+    return ACCEPT_FAILED;
+  }
+#else
+  switch (errno) {
+  case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+  case EWOULDBLOCK:
+#endif // EWOULDBLOCK != EAGAIN
+    return ACCEPT_DRAINED;
+  case EINTR:
+  case ECONNABORTED:
+  case EPROTO:
+  // Linux reports pending network errors of the new connection through accept()
+  case ENETDOWN:
+  case ENETUNREACH:
+  case EHOSTDOWN:
+  case EHOSTUNREACH:
+  case ENOPROTOOPT:
+  case EOPNOTSUPP:
+    return ACCEPT_RETRY;
+  case EMFILE:
+  case ENFILE:
+    return ACCEPT_NO_DESCRIPTORS;
+  default:
+    return ACCEPT_FAILED;
+  }
+#endif // _WIN32
+}
+} // namespace Wepp
@@ -1,13 +1,323 @@
 #include "Wepp/Server/HTTPChecks.hpp"
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
 
 namespace Wepp {
-bool HasHostHeader(const GParsing::HTTPRequest &_req) {
-  for (const auto &header : _req.headers) {
-    if (header.first == "Host" || header.first == "host") {
-      return true;
+static bool EqualsIgnoreCase(const std::string_view &_a, const std::string_view &_b) {
+  if (_a.size() != _b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _a.size(); i++) {
+    if (std::tolower((unsigned char)_a[i]) != std::tolower((unsigned char)_b[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool StartsWithIgnoreCase(const char *_data, const size_t _size, const char *_prefix) {
+  const size_t prefixSize = std::strlen(_prefix);
+  if (_size < prefixSize) {
+    return false;
+  }
+
+  for (size_t i = 0; i < prefixSize; i++) {
+    if (std::tolower((unsigned char)_data[i]) != std::tolower((unsigned char)_prefix[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static std::string_view TrimOptionalWhitespace(std::string_view _value) {
+  while (!_value.empty() && (_value.front() == ' ' || _value.front() == '\t')) {
+    _value.remove_prefix(1);
+  }
+
+  while (!_value.empty() && (_value.back() == ' ' || _value.back() == '\t')) {
+    _value.remove_suffix(1);
+  }
+
+  return _value;
+}
+
+// Calls _func with every non-empty element of a comma separated list, across all lines carrying the header.
+// Elements are views into the request, so nothing is copied. Stops once _func returns false.
+template <typename F> static void ForEachListElement(const RequestView &_req, const KnownHeader _header, F &&_func) {
+  bool proceed = true;
+
+  _req.ForEachValue(_header, [&proceed, &_func](const std::string_view &_value) {
+    for (size_t start = 0; proceed && start <= _value.size();) {
+      size_t end = _value.find(',', start);
+      if (end == std::string_view::npos) {
+        end = _value.size();
+      }
+
+      const std::string_view element = TrimOptionalWhitespace(_value.substr(start, end - start));
+      start = end + 1;
+
+      if (!element.empty()) {
+        proceed = _func(element);
+      }
+    }
+  });
+}
+
+// Leading qvalue digits, "0.5" or "1", ignoring whatever follows like strtod() would
+static double ParseQuality(const std::string_view &_value) {
+  double output = 0.0;
+  double scale = 1.0;
+  bool fraction = false;
+
+  for (const char c : _value) {
+    if (c >= '0' && c <= '9') {
+      if (fraction) {
+        scale /= 10.0;
+        output += (c - '0') * scale;
+      } else {
+        output = output * 10.0 + (c - '0');
+      }
+    } else if (c == '.' && !fraction) {
+      fraction = true;
+    } else {
+      break;
     }
   }
 
+  return output;
+}
+
+// More ranges than this in one request are ignored and the full representation is sent instead
+static constexpr size_t s_MAX_RANGES = 16;
+
+static const char *const s_DAY_NAMES[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char *const s_MONTH_NAMES[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// Days since 1970-01-01 for a proleptic Gregorian date, so no platform timegm() is needed
+static int64_t DaysFromCivil(int64_t _year, const unsigned _month, const unsigned _day) {
+  _year -= _month <= 2;
+  const int64_t era = (_year >= 0 ? _year : _year - 399) / 400;
+  const unsigned yearOfEra = (unsigned)(_year - era * 400);
+  const unsigned dayOfYear = (153 * (_month + (_month > 2 ? -3 : 9)) + 2) / 5 + _day - 1;
+  const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+bool HasHostHeader(const RequestView &_req) {
+  return _req.Has(HEADER_HOST);
+}
+
+bool WantsKeepAlive(const RequestView &_req) {
+  bool keepAlive = _req.Version() != "HTTP/1.0";
+  bool close = false;
+
+  ForEachListElement(_req, HEADER_CONNECTION, [&keepAlive, &close](const std::string_view &_option) {
+    if (EqualsIgnoreCase(_option, "close")) {
+      close = true;
+    } else if (EqualsIgnoreCase(_option, "keep-alive")) {
+      keepAlive = true;
+    }
+
+    return !close;
+  });
+
+  return keepAlive && !close;
+}
+
+double AcceptedEncodingQuality(const RequestView &_req, const char *_coding) {
+  double output = -1.0;
+  double wildcard = -1.0;
+
+  ForEachListElement(_req, HEADER_ACCEPT_ENCODING, [&output, &wildcard, _coding](const std::string_view &_item) {
+    const size_t parameters = _item.find(';');
+    const std::string_view name = TrimOptionalWhitespace(_item.substr(0, parameters));
+
+    double quality = 1.0;
+    const size_t q = parameters == std::string_view::npos ? std::string_view::npos : _item.find("q=", parameters);
+    if (q != std::string_view::npos) {
+      quality = ParseQuality(_item.substr(q + 2));
+    }
+
+    if (EqualsIgnoreCase(name, _coding)) {
+      output = quality;
+      return false;
+    } else if (name == "*") {
+      wildcard = quality;
+    }
+
+    return true;
+  });
+
+  if (output >= 0.0) {
+    return output;
+  }
+
+  return wildcard >= 0.0 ? wildcard : 0.0;
+}
+
+bool MatchesIfNoneMatch(const RequestView &_req, const std::string &_etag) {
+  // Weak comparison, so W/ prefixes are ignored on both sides
+  std::string_view etag(_etag);
+  if (etag.substr(0, 2) == "W/") {
+    etag.remove_prefix(2);
+  }
+
+  bool matched = false;
+
+  ForEachListElement(_req, HEADER_IF_NONE_MATCH, [&matched, &etag](std::string_view _tag) {
+    if (_tag.substr(0, 2) == "W/") {
+      _tag.remove_prefix(2);
+    }
+
+    matched = _tag == "*" || _tag == etag;
+    return !matched;
+  });
+
+  return matched;
+}
+
+bool IsNotModified(const RequestView &_req, const std::string &_etag, const std::time_t _lastModified) {
+  std::string value;
+
+  if (_req.Has(HEADER_IF_NONE_MATCH)) {
+    return MatchesIfNoneMatch(_req, _etag);
+  }
+
+  std::time_t since;
+  if (_req.Join(HEADER_IF_MODIFIED_SINCE, value) && ParseHTTPDate(value, since)) {
+    return _lastModified <= since;
+  }
+
   return false;
 }
+
+RangeResult EvaluateRange(const RequestView &_req, const uint64_t _size, const std::string &_etag, const std::time_t _lastModified, std::vector<ByteRange> &_ranges) {
+  static const char BYTES_UNIT[] = "bytes=";
+  std::string value;
+
+  _ranges.clear();
+
+  if (!_req.Join(HEADER_RANGE, value) || !StartsWithIgnoreCase(value.c_str(), value.size(), BYTES_UNIT)) {
+    return RANGE_NONE;
+  }
+
+  // If-Range needs a strong match, otherwise the client gets the whole current representation
+  std::string condition;
+  if (_req.Join(HEADER_IF_RANGE, condition)) {
+    const size_t start = condition.find_first_not_of(" \t");
+    const size_t end = condition.find_last_not_of(" \t");
+    condition = start == std::string::npos ? "" : condition.substr(start, end - start + 1);
+
+    std::time_t date;
+    if (!condition.empty() && condition[0] == '"') {
+      if (condition != _etag) {
+        return RANGE_NONE;
+      }
+    } else if (!ParseHTTPDate(condition, date) || date != _lastModified) {
+      return RANGE_NONE;
+    }
+  }
+
+  for (size_t start = sizeof(BYTES_UNIT) - 1; start < value.size();) {
+    size_t end = value.find(',', start);
+    if (end == std::string::npos) {
+      end = value.size();
+    }
+
+    const std::string item = value.substr(start, end - start);
+    start = end + 1;
+
+    const size_t dash = item.find('-');
+    const size_t firstStart = item.find_first_not_of(" \t");
+    if (dash == std::string::npos || firstStart == std::string::npos) {
+      return RANGE_NONE;
+    }
+
+    const std::string first = item.substr(firstStart, dash - firstStart);
+    const std::string last = item.substr(dash + 1, item.find_last_not_of(" \t") + 1 - (dash + 1));
+
+    if (first.find_first_not_of("0123456789") != std::string::npos || last.find_first_not_of("0123456789") != std::string::npos || (first.empty() && last.empty()) || first.size() > 18 || last.size() > 18) {
+      return RANGE_NONE;
+    }
+
+    ByteRange range;
+    if (first.empty()) {
+      // Suffix range, the final N bytes
+      const uint64_t suffix = std::strtoull(last.c_str(), nullptr, 10);
+      if (suffix == 0 || _size == 0) {
+        continue;
+      }
+
+      range.first = suffix >= _size ? 0 : _size - suffix;
+      range.last = _size - 1;
+    } else {
+      range.first = std::strtoull(first.c_str(), nullptr, 10);
+      range.last = last.empty() ? _size - 1 : std::strtoull(last.c_str(), nullptr, 10);
+
+      if (!last.empty() && range.last < range.first) {
+        return RANGE_NONE;
+      }
+
+      if (range.first >= _size) {
+        continue;
+      }
+
+      if (range.last >= _size) {
+        range.last = _size - 1;
+      }
+    }
+
+    if (_ranges.size() == s_MAX_RANGES) {
+      _ranges.clear();
+      return RANGE_NONE;
+    }
+
+    _ranges.push_back(range);
+  }
+
+  return _ranges.empty() ? RANGE_UNSATISFIABLE : RANGE_SATISFIABLE;
+}
+
+std::string FormatHTTPDate(const std::time_t _time) {
+  std::tm time;
+#ifdef _WIN32
+  gmtime_s(&time, &_time);
+#else
+  gmtime_r(&_time, &time);
+#endif // _WIN32
+
+  char output[32];
+  std::snprintf(output, sizeof(output), "%s, %02d %s %04d %02d:%02d:%02d GMT", s_DAY_NAMES[time.tm_wday], time.tm_mday, s_MONTH_NAMES[time.tm_mon], time.tm_year + 1900, time.tm_hour, time.tm_min, time.tm_sec);
+  return output;
+}
+
+bool ParseHTTPDate(const std::string &_date, std::time_t &_time) {
+  char day[4] = {};
+  char month[4] = {};
+  int dayOfMonth, year, hour, minute, second;
+
+  if (std::sscanf(_date.c_str(), " %3s, %d %3s %d %d:%d:%d GMT", day, &dayOfMonth, month, &year, &hour, &minute, &second) != 7) {
+    return false;
+  }
+
+  unsigned monthIndex = 0;
+  while (monthIndex < 12 && std::strcmp(month, s_MONTH_NAMES[monthIndex]) != 0) {
+    monthIndex++;
+  }
+
+  if (monthIndex == 12 || dayOfMonth < 1 || dayOfMonth > 31 || hour > 23 || minute > 59 || second > 60) {
+    return false;
+  }
+
+  _time = (std::time_t)(DaysFromCivil(year, monthIndex + 1, dayOfMonth) * 86400 + hour * 3600 + minute * 60 + second);
+  return true;
+}
 } // namespace Wepp
@@ -0,0 +1,82 @@
+#include "Wepp/Server/HTTPStatus.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#define WEPP_HTTP_STATUS(_code, _reason) {_code, _reason, "HTTP/1.1 " #_code " " _reason "\r\n"}
+
+namespace Wepp {
+// Sorted by code for binary search, checked below
+static constexpr std::array<HTTPStatus, 40> s_HTTP_STATUSES = {{
+    WEPP_HTTP_STATUS(100, "Continue"),
+    WEPP_HTTP_STATUS(101, "Switching Protocols"),
+    WEPP_HTTP_STATUS(200, "OK"),
+    WEPP_HTTP_STATUS(201, "Created"),
+    WEPP_HTTP_STATUS(202, "Accepted"),
+    WEPP_HTTP_STATUS(204, "No Content"),
+    WEPP_HTTP_STATUS(206, "Partial Content"),
+    WEPP_HTTP_STATUS(301, "Moved Permanently"),
+    WEPP_HTTP_STATUS(302, "Found"),
+    WEPP_HTTP_STATUS(303, "See Other"),
+    WEPP_HTTP_STATUS(304, "Not Modified"),
+    WEPP_HTTP_STATUS(307, "Temporary Redirect"),
+    WEPP_HTTP_STATUS(308, "Permanent Redirect"),
+    WEPP_HTTP_STATUS(400, "Bad Request"),
+    WEPP_HTTP_STATUS(401, "Unauthorized"),
+    WEPP_HTTP_STATUS(403, "Forbidden"),
+    WEPP_HTTP_STATUS(404, "Not Found"),
+    WEPP_HTTP_STATUS(405, "Method Not Allowed"),
+    WEPP_HTTP_STATUS(406, "Not Acceptable"),
+    WEPP_HTTP_STATUS(408, "Request Timeout"),
+    WEPP_HTTP_STATUS(409, "Conflict"),
+    WEPP_HTTP_STATUS(410, "Gone"),
+    WEPP_HTTP_STATUS(411, "Length Required"),
+    WEPP_HTTP_STATUS(412, "Precondition Failed"),
+    WEPP_HTTP_STATUS(413, "Content Too Large"),
+    WEPP_HTTP_STATUS(414, "URI Too Long"),
+    WEPP_HTTP_STATUS(415, "Unsupported Media Type"),
+    WEPP_HTTP_STATUS(416, "Range Not Satisfiable"),
+    WEPP_HTTP_STATUS(417, "Expectation Failed"),
+    WEPP_HTTP_STATUS(421, "Misdirected Request"),
+    WEPP_HTTP_STATUS(426, "Upgrade Required"),
+    WEPP_HTTP_STATUS(429, "Too Many Requests"),
+    WEPP_HTTP_STATUS(431, "Request Header Fields Too Large"),
+    WEPP_HTTP_STATUS(500, "Internal Server Error"),
+    WEPP_HTTP_STATUS(501, "Not Implemented"),
+    WEPP_HTTP_STATUS(502, "Bad Gateway"),
+    WEPP_HTTP_STATUS(503, "Service Unavailable"),
+    WEPP_HTTP_STATUS(504, "Gateway Timeout"),
+    WEPP_HTTP_STATUS(505, "HTTP Version Not Supported"),
+    WEPP_HTTP_STATUS(507, "Insufficient Storage"),
+}};
+
+static constexpr bool IsSorted() {
+  for (size_t i = 1; i < s_HTTP_STATUSES.size(); i++) {
+    if (s_HTTP_STATUSES[i - 1].code >= s_HTTP_STATUSES[i].code) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static_assert(IsSorted(), "s_HTTP_STATUSES must be sorted by code");
+
+const HTTPStatus *FindHTTPStatus(const int _code) {
+  const auto found = std::lower_bound(s_HTTP_STATUSES.begin(), s_HTTP_STATUSES.end(), _code, [](const HTTPStatus &_status, const int _value) { return _status.code < _value; });
+  return found != s_HTTP_STATUSES.end() && found->code == _code ? &*found : nullptr;
+}
+
+void SetResponseStatus(GParsing::HTTPResponse &_resp, const int _code) {
+  const HTTPStatus *status = FindHTTPStatus(_code);
+
+  _resp.version = "HTTP/1.1";
+  _resp.response_code = _code;
+
+  if (status) {
+    _resp.response_code_message.assign(status->reason.data(), status->reason.size());
+  } else {
+    _resp.response_code_message.clear();
+  }
+}
+} // namespace Wepp
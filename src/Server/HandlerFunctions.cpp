@@ -1,11 +1,85 @@
 #include "Wepp/Server/HandlerFunctions.hpp"
+#include "Wepp/FileHandling/FileCache.hpp"
 #include "Wepp/Server/HTTPChecks.hpp"
-#include "Wepp/FileHandling/FileIO.hpp"
-#include "GLog/Log.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/ResponseBody.hpp"
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 static const std::filesystem::path s_DATA_PATH = "data";
 
+// Files larger than s_MAX_CACHED_FILE_SIZE only have their metadata cached and are streamed from disk
+static constexpr size_t s_FILE_CACHE_SIZE = 64 * 1024 * 1024;
+static constexpr size_t s_MAX_CACHED_FILE_SIZE = 1024 * 1024;
+// Descriptors held open for streamed files, well below the default limit of 1024 per process
+static constexpr size_t s_FILE_CACHE_MAX_OPEN_FILES = 256;
+static constexpr std::chrono::milliseconds s_FILE_CACHE_REVALIDATE_INTERVAL(1000);
+
+// Revalidate by default, the 304 path keeps that cheap
+static const std::string s_DEFAULT_CACHE_CONTROL = "no-cache";
+
+// Sorted longest prefix first so the most specific rule wins
+static std::vector<std::pair<std::string, std::string>> s_cacheControlRules;
+
+static const std::string &FindCacheControl(const std::string &_path) {
+  for (const auto &rule : s_cacheControlRules) {
+    // Whole segments only, so "assets" does not cover "assets-old"
+    if (_path.compare(0, rule.first.size(), rule.first) == 0 && (rule.first.empty() || _path.size() == rule.first.size() || _path[rule.first.size()] == '/')) {
+      return rule.second;
+    }
+  }
+
+  return s_DEFAULT_CACHE_CONTROL;
+}
+
+// Header lines that only depend on the file version, rendered once when it enters the cache
+static std::string RenderCachedHeaders(const Wepp::CachedFile &_file) {
+  std::string output;
+
+  if (_file.encoding != Wepp::ENCODING_IDENTITY) {
+    output += std::string("Content-Encoding: ") + Wepp::ContentEncodingName(_file.encoding) + "\r\n";
+  }
+
+  // Any cached response may differ by Accept-Encoding, even where this one did not
+  output += "Vary: Accept-Encoding\r\n";
+  output += "ETag: " + _file.etag + "\r\n";
+  output += "Last-Modified: " + Wepp::FormatHTTPDate(_file.lastModified) + "\r\n";
+  output += "Cache-Control: " + FindCacheControl(_file.key) + "\r\n";
+  output += "Accept-Ranges: bytes\r\n";
+  return output;
+}
+
+static Wepp::FileCache s_fileCache(s_DATA_PATH, s_FILE_CACHE_SIZE, s_MAX_CACHED_FILE_SIZE, s_FILE_CACHE_MAX_OPEN_FILES, s_FILE_CACHE_REVALIDATE_INTERVAL, RenderCachedHeaders);
+
+// Picks the encoded variant the client weights highest, preferring brotli on ties
+static std::shared_ptr<const Wepp::CachedFile> NegotiateEncoding(const Wepp::RequestView &_req, const std::shared_ptr<const Wepp::CachedFile> &_file) {
+  const double brotli = Wepp::AcceptedEncodingQuality(_req, Wepp::ContentEncodingName(Wepp::ENCODING_BROTLI));
+  const double gzip = Wepp::AcceptedEncodingQuality(_req, Wepp::ContentEncodingName(Wepp::ENCODING_GZIP));
+
+  const std::pair<Wepp::ContentEncoding, double> candidates[] = {
+      brotli >= gzip ? std::make_pair(Wepp::ENCODING_BROTLI, brotli) : std::make_pair(Wepp::ENCODING_GZIP, gzip),
+      brotli >= gzip ? std::make_pair(Wepp::ENCODING_GZIP, gzip) : std::make_pair(Wepp::ENCODING_BROTLI, brotli),
+  };
+
+  for (const auto &candidate : candidates) {
+    if (candidate.second <= 0.0) {
+      continue;
+    }
+
+    std::shared_ptr<const Wepp::CachedFile> variant = s_fileCache.GetVariant(_file, candidate.first);
+    if (variant) {
+      return variant;
+    }
+  }
+
+  return _file;
+}
+
 namespace Wepp {
 void SetupHandling() {
   if (!std::filesystem::exists(std::filesystem::absolute(s_DATA_PATH)) || !std::filesystem::is_directory(std::filesystem::absolute(s_DATA_PATH))) {
@@ -13,68 +87,111 @@ void SetupHandling() {
   }
 }
 
-bool HandleWeb(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp,
-               bool &_closeConnection) {
-  std::vector<unsigned char> buffer;
+void SetCacheControl(const std::string &_pathPrefix, const std::string &_value) {
+  std::string prefix;
+  if (!NormalizeURIPath(_pathPrefix, prefix)) {
+    return;
+  }
 
-  if (!HasHostHeader(_req)) {
-    GLog::Log(GLog::LOG_WARNING, "[Handler]: Connection request did not provide a Host header");
+  for (auto &rule : s_cacheControlRules) {
+    if (rule.first == prefix) {
+      rule.second = _value;
+      return;
+    }
+  }
 
-    if (_req.method != GParsing::GPARSING_UNKNOWN)
-    {
-      buffer = _req.CreateRequest();
-      buffer.push_back('\0');
+  s_cacheControlRules.push_back({prefix, _value});
+  std::stable_sort(s_cacheControlRules.begin(), s_cacheControlRules.end(), [](const auto &_a, const auto &_b) { return _a.first.size() > _b.first.size(); });
+}
 
-      GLog::Log(GLog::LOG_TRACE, (std::string)"[Handler]: " + (char*)buffer.data());
+bool HandleWeb(const RequestView &_req, ResponseBuilder &_resp) {
+  if (!HasHostHeader(_req)) {
+    WEPP_LOG_WARNING("[Handler]: Connection request did not provide a Host header");
+
+    if (_req.Method() != GParsing::GPARSING_UNKNOWN) {
+      WEPP_LOG_TRACE("[Handler]: ", _req.Raw());
     }
 
-    _resp.version = "HTTP/1.1";
-    _resp.response_code = 400;
-    _resp.response_code_message = "Bad Request";
-    _resp.headers.push_back({"Connection", {"close"}});
-    _closeConnection = true;
+    _resp.SetStatus(400);
+    _resp.AddHeader("Connection", "close");
+    _resp.SetCloseConnection(true);
     return false;
   }
 
-  if (_req.uri.find('/') == _req.uri.find("//")) {
-    int index = _req.uri.find("//") + 2;
-    _req.uri.erase(0, index);
-  }
-
-  _req.uri.erase(0, _req.uri.find('/') + 1);
+  std::string_view path = _req.Path();
 
-  if (_req.uri == "") {
-    _req.uri = "index.html";
+  if (!path.empty() && path.front() == '/') {
+    path.remove_prefix(1);
   }
 
-  _resp.version = "HTTP/1.1";
-  _resp.response_code = 200;
-  _resp.response_code_message = "OK";
-
-  GLog::Log(GLog::LOG_TRACE, "[Handler]: Requesting URI - " + std::filesystem::absolute(_req.uri).string());
-  if (std::filesystem::exists(std::filesystem::absolute(s_DATA_PATH / _req.uri))) {
-    GLog::Log(GLog::LOG_TRACE, "[Handler]: File found!");
-    buffer.resize(Wepp::FileSize(std::filesystem::absolute(s_DATA_PATH / _req.uri)));
-    Wepp::ReadFile(std::filesystem::absolute(s_DATA_PATH / _req.uri), buffer);
-
-    _resp.message = buffer;
+  // A view into the request, the cache normalizes it into a reused key
+  const std::string_view uri = path.empty() ? std::string_view("index.html") : path;
+  const bool closeConnection = !WantsKeepAlive(_req);
+
+  _resp.SetCloseConnection(closeConnection);
+  _resp.SetStatus(200);
+
+  WEPP_LOG_TRACE("[Handler]: Requesting URI - ", uri);
+  const std::shared_ptr<const CachedFile> file = s_fileCache.Get(uri);
+  if (file) {
+    // The normalized key, which is what the cache opened beneath its root
+    WEPP_LOG_TRACE("[Handler]: File found - ", file->key);
+
+    const std::shared_ptr<const CachedFile> body = NegotiateEncoding(_req, file);
+
+    _resp.AddRawHeaders(body->headers);
+
+    std::vector<ByteRange> ranges;
+    RangeResult range = RANGE_NONE;
+
+    // RFC 9110 13.1.2: only GET and HEAD are answered with 304, other methods fail the precondition.
+    // RFC 9110 14.2: Range is ignored for every method but GET, which then gets the full representation.
+    const bool safeMethod = _req.Method() == GParsing::GPARSING_GET || _req.Method() == GParsing::GPARSING_HEAD;
+
+    if (!safeMethod && MatchesIfNoneMatch(_req, body->etag)) {
+      _resp.SetStatus(412);
+      _resp.AddHeader("Content-Length", "0");
+    } else if (safeMethod && IsNotModified(_req, body->etag, body->lastModified)) {
+      _resp.SetStatus(304);
+    } else if (_req.Method() == GParsing::GPARSING_GET && (range = EvaluateRange(_req, body->size, body->etag, body->lastModified, ranges)) == RANGE_UNSATISFIABLE) {
+      _resp.SetStatus(416);
+      _resp.AddHeader("Content-Range", "bytes */" + std::to_string(body->size));
+      _resp.AddHeader("Content-Length", "0");
+    } else {
+      _resp.AddHeader("Content-Type", body->contentType);
+
+      if (body->contentsCached) {
+        // Shares the cached buffer, kept alive by the response until it is written
+        _resp.SetBody(std::shared_ptr<const std::vector<unsigned char>>(body, &body->contents));
+        _resp.AddHeader("Content-Length", std::to_string(_resp.GetBodySize()));
+      } else {
+        // Streamed by the server from the cached descriptor, which also sets Content-Length
+        _resp.SetFileBody(body->handle);
+      }
+
+      if (range == RANGE_SATISFIABLE) {
+        _resp.SetRangeBody(body->size, ranges, std::string(body->contentType));
+      }
+    }
   } else {
-    GLog::Log(GLog::LOG_TRACE, "[Handler]: File NOT found!");
-    _resp.response_code = 404;
-    _resp.response_code_message = "Not Found";
+    WEPP_LOG_TRACE("[Handler]: File NOT found!");
+    _resp.SetStatus(404);
+
+    // Persistent connections need explicit framing
+    _resp.AddHeader("Content-Length", std::to_string(_resp.GetBodySize()));
   }
 
-  _resp.headers.push_back({"Connection", {"close"}});
-  _closeConnection = true;
+  _resp.AddHeader("Connection", closeConnection ? "close" : "keep-alive");
 
   return true;
 }
 
-bool HandleWebPost(GParsing::HTTPRequest _req, GParsing::HTTPResponse &_resp) {
-  _resp.version = "HTTP/1.1";
-  _resp.response_code = 100;
-  _resp.response_code_message = "Continue";
-  // _resp.headers.push_back({"Connection", {"keep-alive"}});
+FileCacheStats GetFileCacheStats() {
+  return s_fileCache.GetStats();
+}
+
+bool HandleWebPost(const RequestView &, ResponseBuilder &_resp) {
+  _resp.SetStatus(100);
   return true;
 }
 } // namespace Wepp
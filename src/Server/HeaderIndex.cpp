@@ -0,0 +1,105 @@
+#include "Wepp/Server/HeaderIndex.hpp"
+#include <array>
+
+namespace Wepp {
+struct KnownHeaderName {
+  KnownHeader header;
+  // Lower case
+  const char *name;
+  size_t size;
+};
+
+// Every well-known name has a different length, so classifying a header costs at most one comparison
+static constexpr std::array<KnownHeaderName, HEADER_KNOWN_COUNT> s_KNOWN_HEADERS = {{
+    {HEADER_HOST, "host", 4},
+    {HEADER_RANGE, "range", 5},
+    {HEADER_IF_RANGE, "if-range", 8},
+    {HEADER_CONNECTION, "connection", 10},
+    {HEADER_IF_NONE_MATCH, "if-none-match", 13},
+    {HEADER_ACCEPT_ENCODING, "accept-encoding", 15},
+    {HEADER_IF_MODIFIED_SINCE, "if-modified-since", 17},
+}};
+
+static constexpr size_t s_LONGEST_KNOWN_HEADER = 17;
+
+static constexpr bool KnownHeadersSortedByLength() {
+  for (size_t i = 1; i < s_KNOWN_HEADERS.size(); i++) {
+    if (s_KNOWN_HEADERS[i - 1].size >= s_KNOWN_HEADERS[i].size) {
+      return false;
+    }
+  }
+
+  return s_KNOWN_HEADERS[s_KNOWN_HEADERS.size() - 1].size == s_LONGEST_KNOWN_HEADER;
+}
+
+static_assert(KnownHeadersSortedByLength(), "Well-known header names must be sorted by strictly increasing length");
+
+// Position in s_KNOWN_HEADERS by name length, -1 where no well-known name has that length
+static constexpr std::array<int, s_LONGEST_KNOWN_HEADER + 1> BuildLengthTable() {
+  std::array<int, s_LONGEST_KNOWN_HEADER + 1> output = {};
+
+  for (size_t i = 0; i < output.size(); i++) {
+    output[i] = -1;
+  }
+
+  for (size_t i = 0; i < s_KNOWN_HEADERS.size(); i++) {
+    output[s_KNOWN_HEADERS[i].size] = (int)i;
+  }
+
+  return output;
+}
+
+static constexpr std::array<int, s_LONGEST_KNOWN_HEADER + 1> s_KNOWN_BY_LENGTH = BuildLengthTable();
+
+KnownHeader ClassifyHeader(const std::string_view &_name) {
+  if (_name.size() > s_LONGEST_KNOWN_HEADER || s_KNOWN_BY_LENGTH[_name.size()] < 0) {
+    return HEADER_KNOWN_COUNT;
+  }
+
+  const KnownHeaderName &known = s_KNOWN_HEADERS[s_KNOWN_BY_LENGTH[_name.size()]];
+  for (size_t i = 0; i < known.size; i++) {
+    const unsigned char c = (unsigned char)_name[i];
+    if ((c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c) != (unsigned char)known.name[i]) {
+      return HEADER_KNOWN_COUNT;
+    }
+  }
+
+  return known.header;
+}
+
+HeaderIndex::HeaderIndex() {
+  Clear();
+}
+
+void HeaderIndex::Clear() {
+  for (size_t i = 0; i < HEADER_KNOWN_COUNT; i++) {
+    m_first[i] = s_NONE;
+    m_last[i] = s_NONE;
+  }
+}
+
+void HeaderIndex::Record(const std::string_view &_name, const size_t _position) {
+  const KnownHeader header = ClassifyHeader(_name);
+  if (header == HEADER_KNOWN_COUNT) {
+    return;
+  }
+
+  if (m_first[header] == s_NONE) {
+    m_first[header] = _position;
+  }
+
+  m_last[header] = _position;
+}
+
+bool HeaderIndex::Has(const KnownHeader _header) const {
+  return m_first[_header] != s_NONE;
+}
+
+size_t HeaderIndex::First(const KnownHeader _header) const {
+  return m_first[_header];
+}
+
+size_t HeaderIndex::Last(const KnownHeader _header) const {
+  return m_last[_header];
+}
+} // namespace Wepp
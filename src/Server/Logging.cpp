@@ -0,0 +1,118 @@
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/WorkQueue.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Wepp {
+// The writer thread polls this often while the ring is empty, so producers never have to wake it
+static constexpr std::chrono::milliseconds s_LOG_POLL_INTERVAL(20);
+
+struct LogEntry {
+  GLog::LogLevel level;
+  LogLine line;
+};
+
+// Mirror of the GLog threshold
+static std::atomic<int> s_logLevel(GLog::LOG_TRACE);
+
+static std::unique_ptr<WorkQueue<LogEntry>> s_logQueue;
+static std::atomic<bool> s_asyncLogging(false);
+static std::atomic<uint64_t> s_droppedLogs(0);
+static std::thread s_logThread;
+static std::mutex s_logMutex;
+static std::condition_variable s_logCondition;
+
+static void WriteQueuedLogs() {
+  LogEntry entry;
+
+  while (s_logQueue->TryPop(entry)) {
+    GLog::Log(entry.level, std::string(entry.line.text, entry.line.size));
+  }
+}
+
+static void LogThreadLoop() {
+  while (s_asyncLogging.load(std::memory_order_acquire)) {
+    WriteQueuedLogs();
+
+    std::unique_lock<std::mutex> lock(s_logMutex);
+    s_logCondition.wait_for(lock, s_LOG_POLL_INTERVAL, [] { return !s_asyncLogging.load(std::memory_order_acquire); });
+  }
+
+  WriteQueuedLogs();
+}
+
+bool LogEnabled(const GLog::LogLevel _level) {
+  return (int)_level >= s_logLevel.load(std::memory_order_relaxed);
+}
+
+void SetLogLevel(const GLog::LogLevel _level) {
+  GLog::SetLogLevel(_level);
+  s_logLevel.store(_level, std::memory_order_relaxed);
+}
+
+GLog::LogLevel GetLogLevel() {
+  return (GLog::LogLevel)s_logLevel.load(std::memory_order_relaxed);
+}
+
+void LogLine::Append(const std::string_view &_text) {
+  const size_t length = _text.size() < LOG_LINE_SIZE - 1 - size ? _text.size() : LOG_LINE_SIZE - 1 - size;
+
+  std::memcpy(text + size, _text.data(), length);
+  size += length;
+}
+
+void LogLine::Append(const char _character) {
+  if (size < LOG_LINE_SIZE - 1) {
+    text[size++] = _character;
+  }
+}
+
+void LogMessage(const GLog::LogLevel _level, const LogLine &_line) {
+  if (!s_asyncLogging.load(std::memory_order_acquire)) {
+    GLog::Log(_level, std::string(_line.text, _line.size));
+    return;
+  }
+
+  if (!s_logQueue->TryPush({_level, _line})) {
+    s_droppedLogs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void StartAsyncLogging(const size_t _capacity) {
+  std::lock_guard<std::mutex> lock(s_logMutex);
+
+  if (s_asyncLogging.load()) {
+    return;
+  }
+
+  // Kept after StopAsyncLogging(), a producer may still be pushing into it
+  if (!s_logQueue) {
+    s_logQueue.reset(new WorkQueue<LogEntry>(_capacity));
+  }
+
+  s_asyncLogging.store(true, std::memory_order_release);
+  s_logThread = std::thread(LogThreadLoop);
+}
+
+void StopAsyncLogging() {
+  {
+    std::lock_guard<std::mutex> lock(s_logMutex);
+    s_asyncLogging.store(false, std::memory_order_release);
+  }
+  s_logCondition.notify_all();
+
+  if (s_logThread.joinable()) {
+    s_logThread.join();
+  }
+}
+
+uint64_t GetDroppedLogCount() {
+  return s_droppedLogs.load(std::memory_order_relaxed);
+}
+} // namespace Wepp
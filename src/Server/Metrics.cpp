@@ -0,0 +1,173 @@
+#include "Wepp/Server/Metrics.hpp"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Wepp {
+static constexpr size_t s_CACHE_LINE = 64;
+
+struct alignas(s_CACHE_LINE) MetricsShard {
+  std::atomic<uint64_t> counters[COUNTER_COUNT];
+  std::atomic<uint64_t> buckets[PHASE_COUNT][LatencyHistogram::s_BUCKET_COUNT];
+  std::atomic<uint64_t> counts[PHASE_COUNT];
+  std::atomic<uint64_t> sums[PHASE_COUNT];
+
+  MetricsShard() {
+    for (auto &counter : counters) {
+      counter.store(0, std::memory_order_relaxed);
+    }
+
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+      for (auto &bucket : buckets[phase]) {
+        bucket.store(0, std::memory_order_relaxed);
+      }
+
+      counts[phase].store(0, std::memory_order_relaxed);
+      sums[phase].store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+struct MetricDescription {
+  const char *name;
+  const char *help;
+};
+
+static constexpr MetricDescription s_COUNTER_DESCRIPTIONS[COUNTER_COUNT] = {
+    {"wepp_connections_accepted_total", "Connections accepted"},
+    {"wepp_connections_closed_total", "Connections closed"},
+    {"wepp_connections_rejected_total", "Connections refused by the connection limits"},
+    {"wepp_idle_timeouts_total", "Connections closed after the keep-alive timeout"},
+    {"wepp_handshake_timeouts_total", "Connections closed before their first byte or TLS handshake arrived in time"},
+    {"wepp_read_timeouts_total", "Connections closed while a request was received too slowly"},
+    {"wepp_write_timeouts_total", "Connections closed while a response could not be written in time"},
+    {"wepp_tls_handshakes_failed_total", "TLS handshakes that failed"},
+    {"wepp_requests_total", "Requests received"},
+    {"wepp_requests_rejected_total", "Requests rejected while framing with 400, 413 or 431"},
+    {"wepp_responses_1xx_total", "Responses sent with a 1xx status"},
+    {"wepp_responses_2xx_total", "Responses sent with a 2xx status"},
+    {"wepp_responses_3xx_total", "Responses sent with a 3xx status"},
+    {"wepp_responses_4xx_total", "Responses sent with a 4xx status"},
+    {"wepp_responses_5xx_total", "Responses sent with a 5xx status"},
+    {"wepp_received_bytes_total", "Bytes read from clients"},
+    {"wepp_sent_bytes_total", "Bytes written to clients"},
+};
+
+static constexpr const char *s_PHASE_NAMES[PHASE_COUNT] = {"accept", "handshake", "parse", "handler", "send"};
+
+// Shards outlive their threads so counts recorded by exited threads are kept
+static std::mutex s_shardsMutex;
+static std::vector<std::unique_ptr<MetricsShard>> s_shards;
+
+static MetricsShard &LocalShard() {
+  thread_local MetricsShard *shard = nullptr;
+
+  if (!shard) {
+    std::lock_guard<std::mutex> lock(s_shardsMutex);
+    s_shards.emplace_back(new MetricsShard());
+    shard = s_shards.back().get();
+  }
+
+  return *shard;
+}
+
+size_t LatencyHistogram::BucketIndex(const uint64_t _micros) {
+  if (_micros < s_SUB_BUCKETS) {
+    return _micros;
+  }
+
+  // Index of the highest set bit, capped so the shift never reaches the width of the type
+  size_t exponent = 0;
+  while (exponent + 1 < 64 && (_micros >> (exponent + 1)) != 0) {
+    exponent++;
+  }
+
+  const size_t sub = (_micros >> (exponent - s_SUB_BUCKET_BITS)) & (s_SUB_BUCKETS - 1);
+  const size_t index = s_SUB_BUCKETS + (exponent - s_SUB_BUCKET_BITS) * s_SUB_BUCKETS + sub;
+  return index < s_BUCKET_COUNT ? index : s_BUCKET_COUNT - 1;
+}
+
+uint64_t LatencyHistogram::BucketLimit(const size_t _index) {
+  if (_index < s_SUB_BUCKETS) {
+    return _index + 1;
+  }
+
+  const size_t exponent = (_index - s_SUB_BUCKETS) / s_SUB_BUCKETS + s_SUB_BUCKET_BITS;
+  const size_t sub = (_index - s_SUB_BUCKETS) % s_SUB_BUCKETS;
+  return (uint64_t)(s_SUB_BUCKETS + sub + 1) << (exponent - s_SUB_BUCKET_BITS);
+}
+
+void CountMetric(const MetricCounter _counter, const uint64_t _amount) {
+  LocalShard().counters[_counter].fetch_add(_amount, std::memory_order_relaxed);
+}
+
+void RecordLatency(const MetricPhase _phase, const std::chrono::steady_clock::duration &_duration) {
+  const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(_duration).count();
+  const uint64_t value = micros < 0 ? 0 : (uint64_t)micros;
+  MetricsShard &shard = LocalShard();
+
+  shard.buckets[_phase][LatencyHistogram::BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  shard.counts[_phase].fetch_add(1, std::memory_order_relaxed);
+  shard.sums[_phase].fetch_add(value, std::memory_order_relaxed);
+}
+
+MetricsSnapshot GetMetrics() {
+  MetricsSnapshot output = {};
+
+  std::lock_guard<std::mutex> lock(s_shardsMutex);
+  for (const auto &shard : s_shards) {
+    for (size_t counter = 0; counter < COUNTER_COUNT; counter++) {
+      output.counters[counter] += shard->counters[counter].load(std::memory_order_relaxed);
+    }
+
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+      for (size_t bucket = 0; bucket < LatencyHistogram::s_BUCKET_COUNT; bucket++) {
+        output.phases[phase].buckets[bucket] += shard->buckets[phase][bucket].load(std::memory_order_relaxed);
+      }
+
+      output.phases[phase].count += shard->counts[phase].load(std::memory_order_relaxed);
+      output.phases[phase].sumMicros += shard->sums[phase].load(std::memory_order_relaxed);
+    }
+  }
+
+  return output;
+}
+
+void RenderMetrics(std::string &_output) {
+  const MetricsSnapshot metrics = GetMetrics();
+  char line[256];
+
+  for (size_t counter = 0; counter < COUNTER_COUNT; counter++) {
+    const MetricDescription &description = s_COUNTER_DESCRIPTIONS[counter];
+    std::snprintf(line, sizeof(line), "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", description.name, description.help, description.name, description.name, (unsigned long long)metrics.counters[counter]);
+    _output += line;
+  }
+
+  _output += "# HELP wepp_connections_active Connections currently open\n# TYPE wepp_connections_active gauge\n";
+  std::snprintf(line, sizeof(line), "wepp_connections_active %llu\n", (unsigned long long)(metrics.counters[COUNTER_CONNECTIONS_ACCEPTED] - metrics.counters[COUNTER_CONNECTIONS_CLOSED]));
+  _output += line;
+
+  _output += "# HELP wepp_phase_duration_seconds Time spent per request phase\n# TYPE wepp_phase_duration_seconds histogram\n";
+
+  for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+    const LatencyHistogram &histogram = metrics.phases[phase];
+    uint64_t cumulative = 0;
+
+    // The last bucket is open ended and only appears as +Inf
+    for (size_t bucket = 0; bucket + 1 < LatencyHistogram::s_BUCKET_COUNT; bucket++) {
+      cumulative += histogram.buckets[bucket];
+      std::snprintf(line, sizeof(line), "wepp_phase_duration_seconds_bucket{phase=\"%s\",le=\"%.6g\"} %llu\n", s_PHASE_NAMES[phase], (double)LatencyHistogram::BucketLimit(bucket) / 1e6, (unsigned long long)cumulative);
+      _output += line;
+    }
+
+    std::snprintf(line, sizeof(line), "wepp_phase_duration_seconds_bucket{phase=\"%s\",le=\"+Inf\"} %llu\n", s_PHASE_NAMES[phase], (unsigned long long)histogram.count);
+    _output += line;
+    std::snprintf(line, sizeof(line), "wepp_phase_duration_seconds_sum{phase=\"%s\"} %.6f\n", s_PHASE_NAMES[phase], (double)histogram.sumMicros / 1e6);
+    _output += line;
+    std::snprintf(line, sizeof(line), "wepp_phase_duration_seconds_count{phase=\"%s\"} %llu\n", s_PHASE_NAMES[phase], (unsigned long long)histogram.count);
+    _output += line;
+  }
+}
+} // namespace Wepp
@@ -0,0 +1,50 @@
+#include "Wepp/Server/RequestHandler.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include <exception>
+#include <vector>
+
+namespace Wepp {
+static bool ToHTTPRequest(const RequestView &_view, GParsing::HTTPRequest &_req) {
+  // GParsing expects a terminated buffer
+  std::vector<unsigned char> buffer(_view.Raw().begin(), _view.Raw().end());
+  buffer.push_back('\0');
+
+  try {
+    _req.ParseRequest(buffer);
+  } catch (const std::exception &e) {
+    WEPP_LOG_WARNING("Failed to Parse HTTP from buffer. Error: ", e.what());
+    return false;
+  }
+
+  return true;
+}
+
+WEPP_REQUEST_HANDLER AdaptHandler(const WEPP_HANDLER_FUNC _handler) {
+  return [_handler](const RequestView &_view, ResponseBuilder &_resp) {
+    GParsing::HTTPRequest req;
+    bool closeConnection = true;
+
+    if (!ToHTTPRequest(_view, req)) {
+      _resp.SetStatus(400);
+      _resp.SetHeader("Content-Length", "0");
+      _resp.SetCloseConnection(true);
+      return false;
+    }
+
+    const bool output = _handler(req, _resp.GetResponse(), closeConnection);
+    _resp.SetCloseConnection(closeConnection);
+    return output;
+  };
+}
+
+WEPP_REQUEST_HANDLER AdaptPostHandler(const WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler) {
+  if (!_postHandler) {
+    return WEPP_REQUEST_HANDLER();
+  }
+
+  return [_postHandler](const RequestView &_view, ResponseBuilder &_resp) {
+    GParsing::HTTPRequest req;
+    return ToHTTPRequest(_view, req) && _postHandler(req, _resp.GetResponse());
+  };
+}
+} // namespace Wepp
@@ -0,0 +1,326 @@
+#include "Wepp/Server/RequestParser.hpp"
+#include "Wepp/Server/ByteScan.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace Wepp {
+// Chunk size lines only carry a hex length and optional extensions
+static constexpr size_t s_MAX_CHUNK_LINE_SIZE = 1024;
+
+static bool StartsWithIgnoreCase(const char *_data, const size_t _size, const char *_prefix) {
+  const size_t prefixSize = std::strlen(_prefix);
+  if (_size < prefixSize) {
+    return false;
+  }
+
+  for (size_t i = 0; i < prefixSize; i++) {
+    if (std::tolower((unsigned char)_data[i]) != std::tolower((unsigned char)_prefix[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static int HexValue(const unsigned char _c) {
+  if (_c >= '0' && _c <= '9') {
+    return _c - '0';
+  } else if (_c >= 'a' && _c <= 'f') {
+    return _c - 'a' + 10;
+  } else if (_c >= 'A' && _c <= 'F') {
+    return _c - 'A' + 10;
+  }
+
+  return -1;
+}
+
+RequestParser::RequestParser() {
+  Reset();
+}
+
+ParseStatus RequestParser::Parse(std::vector<unsigned char> &_buffer, const size_t _maxHeaderSize, const uint64_t _maxBodySize) {
+  static constexpr size_t HEADER_END_SIZE = 4;
+
+  switch (m_state) {
+  case PARSER_HEADERS: {
+    // Resume a few bytes back in case the terminator straddles two reads
+    const size_t start = m_scanned < HEADER_END_SIZE ? 0 : m_scanned - (HEADER_END_SIZE - 1);
+    const size_t headerEnd = FindHeaderEnd(_buffer.data(), _buffer.size(), start);
+
+    if (headerEnd == _buffer.size()) {
+      m_scanned = _buffer.size();
+      return m_scanned > _maxHeaderSize ? _Fail(431) : PARSE_INCOMPLETE;
+    }
+
+    m_headerSize = headerEnd + HEADER_END_SIZE;
+    if (m_headerSize > _maxHeaderSize) {
+      return _Fail(431);
+    }
+
+    m_scanned = m_headerSize;
+    m_bodyEnd = m_headerSize;
+
+    const ParseStatus status = _ParseHeaders(_buffer, _maxBodySize);
+    if (status != PARSE_INCOMPLETE) {
+      return status;
+    }
+
+    return Parse(_buffer, _maxHeaderSize, _maxBodySize);
+  }
+  case PARSER_BODY:
+    if (_buffer.size() - m_headerSize < m_remaining) {
+      return PARSE_INCOMPLETE;
+    }
+
+    m_scanned = m_headerSize + m_remaining;
+    m_bodyEnd = m_scanned;
+    m_state = PARSER_DONE;
+    return PARSE_COMPLETE;
+  case PARSER_DONE:
+    return PARSE_COMPLETE;
+  default:
+    return _ParseChunked(_buffer, _maxHeaderSize, _maxBodySize);
+  }
+}
+
+size_t RequestParser::RequestSize() const {
+  return m_bodyEnd;
+}
+
+size_t RequestParser::ConsumedSize() const {
+  return m_scanned;
+}
+
+int RequestParser::ErrorStatus() const {
+  return m_errorStatus;
+}
+
+bool RequestParser::HeadersComplete() const {
+  return m_state != PARSER_HEADERS;
+}
+
+void RequestParser::Reset() {
+  m_state = PARSER_HEADERS;
+  m_scanned = 0;
+  m_headerSize = 0;
+  m_bodyEnd = 0;
+  m_remaining = 0;
+  m_codingLineStart = 0;
+  m_codingLineSize = 0;
+  m_errorStatus = 0;
+}
+
+ParseStatus RequestParser::_ParseHeaders(const std::vector<unsigned char> &_buffer, const uint64_t _maxBodySize) {
+  static const char CONTENT_LENGTH[] = "Content-Length";
+  static const char TRANSFER_ENCODING[] = "Transfer-Encoding";
+
+  const char *headers = (const char *)_buffer.data();
+  bool hasContentLength = false;
+  bool chunked = false;
+  uint64_t contentLength = 0;
+
+  // Lines start after each LF in the header block. The request line never matches either name.
+  for (size_t lineStart = 0; lineStart < m_headerSize;) {
+    size_t colon;
+    const size_t lineSize = FindLineEnd(_buffer.data(), m_headerSize, lineStart, colon) - lineStart;
+    const size_t nameSize = colon == m_headerSize ? 0 : colon - lineStart;
+    const char *line = headers + lineStart;
+
+    // Names are told apart by length first, so most lines are skipped without a comparison
+    if (nameSize == sizeof(CONTENT_LENGTH) - 1 && StartsWithIgnoreCase(line, lineSize, CONTENT_LENGTH)) {
+      size_t digits = 0;
+      uint64_t value = 0;
+
+      for (size_t i = nameSize + 1; i < lineSize; i++) {
+        if (line[i] >= '0' && line[i] <= '9') {
+          value = value * 10 + (line[i] - '0');
+          digits++;
+        } else if (line[i] != ' ' && line[i] != '\t' && line[i] != '\r') {
+          return _Fail(400);
+        }
+      }
+
+      // Also rejects lengths that would overflow, and conflicting duplicates
+      if (digits == 0 || digits > 18 || (hasContentLength && value != contentLength)) {
+        return _Fail(400);
+      }
+
+      hasContentLength = true;
+      contentLength = value;
+    } else if (nameSize == sizeof(TRANSFER_ENCODING) - 1 && StartsWithIgnoreCase(line, lineSize, TRANSFER_ENCODING)) {
+      size_t first = nameSize + 1;
+      size_t last = lineSize;
+
+      while (first < last && (line[first] == ' ' || line[first] == '\t')) {
+        first++;
+      }
+
+      while (last > first && (line[last - 1] == ' ' || line[last - 1] == '\t' || line[last - 1] == '\r')) {
+        last--;
+      }
+
+      // Chunked applied twice is invalid
+      if (chunked) {
+        return _Fail(400);
+      }
+
+      // Only chunked on its own is understood. Anything layered under it would still be encoded once the
+      // framing is removed, so it is refused rather than handed on as if it were plain content.
+      if (last - first != 7 || !StartsWithIgnoreCase(line + first, last - first, "chunked")) {
+        return _Fail(501);
+      }
+
+      chunked = true;
+      m_codingLineStart = lineStart;
+      m_codingLineSize = lineSize + 1;
+    }
+
+    lineStart += lineSize + 1;
+  }
+
+  // Both framings at once is a request smuggling vector, so refuse instead of picking one
+  if (chunked && hasContentLength) {
+    return _Fail(400);
+  }
+
+  if (chunked) {
+    m_state = PARSER_CHUNK_SIZE;
+    return PARSE_INCOMPLETE;
+  }
+
+  if (contentLength > _maxBodySize) {
+    return _Fail(413);
+  }
+
+  m_remaining = contentLength;
+  m_state = PARSER_BODY;
+  return PARSE_INCOMPLETE;
+}
+
+ParseStatus RequestParser::_ParseChunked(std::vector<unsigned char> &_buffer, const size_t _maxHeaderSize, const uint64_t _maxBodySize) {
+  while (true) {
+    switch (m_state) {
+    case PARSER_CHUNK_SIZE: {
+      const unsigned char *lineEnd = (const unsigned char *)std::memchr(_buffer.data() + m_scanned, '\n', _buffer.size() - m_scanned);
+      if (!lineEnd) {
+        return _buffer.size() - m_scanned > s_MAX_CHUNK_LINE_SIZE ? _Fail(400) : PARSE_INCOMPLETE;
+      }
+
+      const size_t lineSize = lineEnd - (_buffer.data() + m_scanned);
+      uint64_t size = 0;
+      size_t digits = 0;
+      int value;
+
+      while (digits < lineSize && (value = HexValue(_buffer[m_scanned + digits])) >= 0) {
+        size = (size << 4) | value;
+        digits++;
+      }
+
+      // RFC 9112 7.1: chunk-size [ BWS ";" chunk-ext ] CRLF, anything else after the digits is malformed
+      size_t position = digits;
+      while (position < lineSize && (_buffer[m_scanned + position] == ' ' || _buffer[m_scanned + position] == '\t')) {
+        position++;
+      }
+
+      const bool extension = position < lineSize && _buffer[m_scanned + position] == ';';
+
+      if (digits == 0 || lineSize > s_MAX_CHUNK_LINE_SIZE || _buffer[m_scanned + lineSize - 1] != '\r' || (!extension && position != lineSize - 1)) {
+        return _Fail(400);
+      }
+
+      if (digits > 15 || (m_bodyEnd - m_headerSize) + size > _maxBodySize) {
+        return _Fail(413);
+      }
+
+      m_scanned += lineSize + 1;
+      m_remaining = size;
+      m_state = size == 0 ? PARSER_TRAILERS : PARSER_CHUNK_DATA;
+      break;
+    }
+    case PARSER_CHUNK_DATA: {
+      const uint64_t available = _buffer.size() - m_scanned;
+      const size_t size = (size_t)(available < m_remaining ? available : m_remaining);
+      if (size == 0) {
+        return PARSE_INCOMPLETE;
+      }
+
+      // Decode in place by sliding chunk data over the framing already consumed
+      if (m_bodyEnd != m_scanned) {
+        std::memmove(_buffer.data() + m_bodyEnd, _buffer.data() + m_scanned, size);
+      }
+
+      m_bodyEnd += size;
+      m_scanned += size;
+      m_remaining -= size;
+
+      if (m_remaining == 0) {
+        m_state = PARSER_CHUNK_DATA_END;
+      }
+
+      break;
+    }
+    case PARSER_CHUNK_DATA_END:
+      if (_buffer.size() - m_scanned < 2) {
+        return PARSE_INCOMPLETE;
+      }
+
+      if (_buffer[m_scanned] != '\r' || _buffer[m_scanned + 1] != '\n') {
+        return _Fail(400);
+      }
+
+      m_scanned += 2;
+      m_state = PARSER_CHUNK_SIZE;
+      break;
+    case PARSER_TRAILERS: {
+      // Trailer fields are read past and dropped. m_remaining counts their size against the header limit.
+      const unsigned char *lineEnd = (const unsigned char *)std::memchr(_buffer.data() + m_scanned, '\n', _buffer.size() - m_scanned);
+      if (!lineEnd) {
+        return m_remaining + (_buffer.size() - m_scanned) > _maxHeaderSize ? _Fail(431) : PARSE_INCOMPLETE;
+      }
+
+      const size_t lineSize = lineEnd - (_buffer.data() + m_scanned);
+      m_scanned += lineSize + 1;
+      m_remaining += lineSize + 1;
+
+      if (lineSize == 0 || (lineSize == 1 && lineEnd[-1] == '\r')) {
+        m_state = PARSER_DONE;
+        return _ReplaceTransferEncoding(_buffer);
+      }
+
+      if (m_remaining > _maxHeaderSize) {
+        return _Fail(431);
+      }
+
+      break;
+    }
+    default:
+      return PARSE_COMPLETE;
+    }
+  }
+}
+
+ParseStatus RequestParser::_ReplaceTransferEncoding(std::vector<unsigned char> &_buffer) {
+  char line[48];
+  const int lineSize = std::snprintf(line, sizeof(line), "Content-Length: %llu\r\n", (unsigned long long)(m_bodyEnd - m_headerSize));
+  const size_t codingLineEnd = m_codingLineStart + m_codingLineSize;
+
+  // Framing removed from the body leaves room for a longer line, unless the body is larger than any sane limit
+  if (lineSize < 0 || m_bodyEnd - m_codingLineSize + lineSize > m_scanned) {
+    return _Fail(413);
+  }
+
+  // Shifts the remaining headers and the decoded body together
+  std::memmove(_buffer.data() + m_codingLineStart + lineSize, _buffer.data() + codingLineEnd, m_bodyEnd - codingLineEnd);
+  std::memcpy(_buffer.data() + m_codingLineStart, line, lineSize);
+
+  m_headerSize = m_headerSize - m_codingLineSize + lineSize;
+  m_bodyEnd = m_bodyEnd - m_codingLineSize + lineSize;
+  return PARSE_COMPLETE;
+}
+
+ParseStatus RequestParser::_Fail(const int _status) {
+  m_errorStatus = _status;
+  return PARSE_ERROR;
+}
+} // namespace Wepp
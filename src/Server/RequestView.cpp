@@ -0,0 +1,207 @@
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ByteScan.hpp"
+
+namespace Wepp {
+struct MethodMapping {
+  const char *name;
+  GParsing::HTTPMethod method;
+};
+
+static constexpr MethodMapping s_METHODS[] = {
+    {"GET", GParsing::GPARSING_GET},
+    {"HEAD", GParsing::GPARSING_HEAD},
+    {"POST", GParsing::GPARSING_POST},
+    {"PUT", GParsing::GPARSING_PUT},
+    {"DELETE", GParsing::GPARSING_DELETE},
+    {"OPTIONS", GParsing::GPARSING_OPTIONS},
+};
+
+static bool EqualsIgnoreCase(const std::string_view &_a, const std::string_view &_b) {
+  if (_a.size() != _b.size()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < _a.size(); i++) {
+    const unsigned char a = (unsigned char)_a[i];
+    const unsigned char b = (unsigned char)_b[i];
+    if ((a >= 'A' && a <= 'Z' ? a + ('a' - 'A') : a) != (b >= 'A' && b <= 'Z' ? b + ('a' - 'A') : b)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static std::string_view TrimWhitespace(std::string_view _value) {
+  while (!_value.empty() && (_value.front() == ' ' || _value.front() == '\t')) {
+    _value.remove_prefix(1);
+  }
+
+  while (!_value.empty() && (_value.back() == ' ' || _value.back() == '\t')) {
+    _value.remove_suffix(1);
+  }
+
+  return _value;
+}
+
+RequestView::RequestView() : m_method(GParsing::GPARSING_UNKNOWN) {}
+
+bool RequestView::Parse(const unsigned char *_data, const size_t _size) {
+  const char *data = (const char *)_data;
+  size_t lineStart = 0;
+
+  m_raw = std::string_view(data, _size);
+  m_method = GParsing::GPARSING_UNKNOWN;
+  m_methodName = m_target = m_version = m_body = std::string_view();
+  m_headers.clear();
+  m_index.Clear();
+
+  while (true) {
+    // Finds the line end and the name/value separator in one vectorized pass
+    size_t colon;
+    const size_t lineEnd = FindLineEnd(_data, _size, lineStart, colon);
+    if (lineEnd == _size) {
+      return false;
+    }
+
+    std::string_view line(data + lineStart, lineEnd - lineStart);
+    colon = colon == _size ? std::string_view::npos : colon - lineStart;
+    lineStart = lineEnd + 1;
+
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
+    if (m_methodName.empty()) {
+      // METHOD SP request-target SP HTTP-version
+      const size_t methodEnd = line.find(' ');
+      const size_t targetEnd = methodEnd == std::string_view::npos ? std::string_view::npos : line.find(' ', methodEnd + 1);
+      if (methodEnd == 0 || targetEnd == std::string_view::npos || targetEnd == methodEnd + 1) {
+        return false;
+      }
+
+      m_methodName = line.substr(0, methodEnd);
+      m_target = line.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+      m_version = line.substr(targetEnd + 1);
+
+      for (const MethodMapping &method : s_METHODS) {
+        if (m_methodName == method.name) {
+          m_method = method.method;
+        }
+      }
+
+      continue;
+    }
+
+    if (line.empty()) {
+      break;
+    }
+
+    // Obsolete line folding is refused rather than unfolded
+    if (colon == 0 || colon == std::string_view::npos || line.front() == ' ' || line.front() == '\t') {
+      return false;
+    }
+
+    const std::string_view name = line.substr(0, colon);
+    if (name.back() == ' ' || name.back() == '\t') {
+      return false;
+    }
+
+    m_index.Record(name, m_headers.size());
+    m_headers.push_back({name, TrimWhitespace(line.substr(colon + 1))});
+  }
+
+  m_body = std::string_view(data + lineStart, _size - lineStart);
+  return true;
+}
+
+GParsing::HTTPMethod RequestView::Method() const {
+  return m_method;
+}
+
+std::string_view RequestView::MethodName() const {
+  return m_methodName;
+}
+
+std::string_view RequestView::Target() const {
+  return m_target;
+}
+
+std::string_view RequestView::Path() const {
+  std::string_view path = m_target;
+
+  // Absolute form, "http://host/path"
+  const size_t scheme = path.find("://");
+  if (!path.empty() && path.front() != '/' && scheme != std::string_view::npos) {
+    const size_t start = path.find('/', scheme + 3);
+    path = start == std::string_view::npos ? std::string_view("/") : path.substr(start);
+  }
+
+  return path.substr(0, path.find_first_of("?#"));
+}
+
+std::string_view RequestView::Query() const {
+  const size_t start = m_target.find('?');
+  if (start == std::string_view::npos) {
+    return std::string_view();
+  }
+
+  return m_target.substr(start + 1, m_target.find('#', start) - (start + 1));
+}
+
+std::string_view RequestView::Version() const {
+  return m_version;
+}
+
+std::string_view RequestView::Body() const {
+  return m_body;
+}
+
+std::string_view RequestView::Raw() const {
+  return m_raw;
+}
+
+const std::vector<RequestHeader> &RequestView::Headers() const {
+  return m_headers;
+}
+
+bool RequestView::Has(const KnownHeader _header) const {
+  return m_index.Has(_header);
+}
+
+bool RequestView::Join(const KnownHeader _header, std::string &_value) const {
+  bool found = false;
+  _value.clear();
+
+  ForEachValue(_header, [&found, &_value](const std::string_view &_part) {
+    if (found) {
+      _value += ',';
+    }
+
+    _value += _part;
+    found = true;
+  });
+
+  return found;
+}
+
+std::string_view RequestView::Find(const std::string_view &_name) const {
+  for (const RequestHeader &header : m_headers) {
+    if (EqualsIgnoreCase(header.name, _name)) {
+      return header.value;
+    }
+  }
+
+  return std::string_view();
+}
+
+std::string_view HTTPMethodName(const GParsing::HTTPMethod _method) {
+  for (const MethodMapping &method : s_METHODS) {
+    if (method.method == _method) {
+      return method.name;
+    }
+  }
+
+  return std::string_view();
+}
+} // namespace Wepp
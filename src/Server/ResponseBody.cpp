@@ -0,0 +1,92 @@
+#include "Wepp/Server/ResponseBody.hpp"
+#include "Wepp/Server/HTTPStatus.hpp"
+#include <cstdio>
+#include <random>
+
+namespace Wepp {
+static std::string ContentRange(const ByteRange &_range, const uint64_t _size) {
+  char output[96];
+  std::snprintf(output, sizeof(output), "bytes %llu-%llu/%llu", (unsigned long long)_range.first, (unsigned long long)_range.last, (unsigned long long)_size);
+  return output;
+}
+
+static std::string MultipartBoundary() {
+  thread_local std::mt19937_64 generator(std::random_device{}());
+
+  char output[32];
+  std::snprintf(output, sizeof(output), "%016llx", (unsigned long long)generator());
+  return output;
+}
+
+static void SetHeader(GParsing::HTTPResponse &_resp, const std::string &_name, const std::string &_value) {
+  for (auto &header : _resp.headers) {
+    if (header.first == _name) {
+      header.second = {_value};
+      return;
+    }
+  }
+
+  _resp.headers.push_back({_name, {_value}});
+}
+
+void SetRangeBody(GParsing::HTTPResponse &_resp, FileBody *_fileBody, const uint64_t _size, const std::vector<ByteRange> &_ranges, const std::string &_contentType) {
+  std::vector<unsigned char> message;
+  std::string boundary;
+
+  SetResponseStatus(_resp, 206);
+
+  if (_ranges.size() == 1) {
+    SetHeader(_resp, "Content-Range", ContentRange(_ranges[0], _size));
+  } else {
+    boundary = MultipartBoundary();
+    SetHeader(_resp, "Content-Type", "multipart/byteranges; boundary=" + boundary);
+  }
+
+  if (_fileBody) {
+    _fileBody->parts.clear();
+  }
+
+  for (size_t i = 0; i <= _ranges.size(); i++) {
+    std::string framing;
+
+    if (!boundary.empty()) {
+      framing = (i == 0 ? "--" : "\r\n--") + boundary;
+
+      if (i == _ranges.size()) {
+        framing += "--\r\n";
+      } else {
+        framing += "\r\n";
+
+        if (!_contentType.empty()) {
+          framing += "Content-Type: " + _contentType + "\r\n";
+        }
+
+        framing += "Content-Range: " + ContentRange(_ranges[i], _size) + "\r\n\r\n";
+      }
+    }
+
+    if (_fileBody) {
+      if (!framing.empty()) {
+        _fileBody->parts.push_back({std::move(framing), 0, 0});
+      }
+
+      if (i < _ranges.size()) {
+        _fileBody->parts.push_back({"", _ranges[i].first, _ranges[i].last - _ranges[i].first + 1});
+      }
+
+      continue;
+    }
+
+    message.insert(message.end(), framing.begin(), framing.end());
+
+    if (i < _ranges.size() && _ranges[i].last < _resp.message.size()) {
+      message.insert(message.end(), _resp.message.begin() + _ranges[i].first, _resp.message.begin() + _ranges[i].last + 1);
+    }
+  }
+
+  if (!_fileBody) {
+    _resp.message = std::move(message);
+    SetHeader(_resp, "Content-Length", std::to_string(_resp.message.size()));
+  }
+}
+} // namespace Wepp
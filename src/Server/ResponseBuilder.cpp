@@ -0,0 +1,126 @@
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include "Wepp/Server/HTTPStatus.hpp"
+#include <algorithm>
+#include <cctype>
+
+namespace Wepp {
+ResponseBuilder::ResponseBuilder(GParsing::HTTPResponse &_response) : m_response(_response), m_closeConnection(true) {
+  SetResponseStatus(m_response, 200);
+}
+
+void ResponseBuilder::SetStatus(const int _code) {
+  SetResponseStatus(m_response, _code);
+}
+
+int ResponseBuilder::GetStatus() const {
+  return m_response.response_code;
+}
+
+// Headers most responses carry, reserved on the first one so the list does not regrow while it is filled
+static constexpr size_t s_RESERVED_HEADERS = 8;
+
+void ResponseBuilder::AddHeader(const std::string_view &_name, const std::string_view &_value) {
+  if (m_response.headers.capacity() == 0) {
+    m_response.headers.reserve(s_RESERVED_HEADERS);
+  }
+
+  // Built in place, a braced pair would copy the value list once more
+  m_response.headers.emplace_back(std::string(_name), std::vector<std::string>());
+  m_response.headers.back().second.emplace_back(_value);
+}
+
+void ResponseBuilder::SetHeader(const std::string_view &_name, const std::string_view &_value) {
+  const auto matches = [&_name](const std::pair<std::string, std::vector<std::string>> &_header) {
+    return _header.first.size() == _name.size() &&
+           std::equal(_header.first.begin(), _header.first.end(), _name.begin(), [](const char _a, const char _b) { return std::tolower((unsigned char)_a) == std::tolower((unsigned char)_b); });
+  };
+
+  m_response.headers.erase(std::remove_if(m_response.headers.begin(), m_response.headers.end(), matches), m_response.headers.end());
+  AddHeader(_name, _value);
+}
+
+void ResponseBuilder::AddRawHeaders(const std::string &_lines) {
+  m_rawHeaders += _lines;
+}
+
+const std::string &ResponseBuilder::GetRawHeaders() const {
+  return m_rawHeaders;
+}
+
+void ResponseBuilder::SetBody(std::vector<unsigned char> &&_body) {
+  m_fileBody = FileBody();
+  m_sharedBody.reset();
+  m_response.message = std::move(_body);
+}
+
+void ResponseBuilder::SetBody(const std::vector<unsigned char> &_body) {
+  m_fileBody = FileBody();
+  m_sharedBody.reset();
+  m_response.message = _body;
+}
+
+void ResponseBuilder::SetBody(const std::string_view &_body) {
+  m_fileBody = FileBody();
+  m_sharedBody.reset();
+  m_response.message.assign(_body.begin(), _body.end());
+}
+
+void ResponseBuilder::SetBody(const std::shared_ptr<const std::vector<unsigned char>> &_body) {
+  m_fileBody = FileBody();
+  m_response.message.clear();
+  m_sharedBody = _body;
+}
+
+size_t ResponseBuilder::GetBodySize() const {
+  return m_sharedBody ? m_sharedBody->size() : m_response.message.size();
+}
+
+bool ResponseBuilder::TakeSharedBody(std::shared_ptr<const std::vector<unsigned char>> &_body) {
+  if (!m_sharedBody) {
+    return false;
+  }
+
+  _body = std::move(m_sharedBody);
+  m_sharedBody.reset();
+  return true;
+}
+
+void ResponseBuilder::SetFileBody(const std::shared_ptr<const FileHandle> &_file) {
+  m_response.message.clear();
+  m_sharedBody.reset();
+  m_fileBody.file = _file;
+  m_fileBody.parts.clear();
+}
+
+bool ResponseBuilder::TakeFileBody(FileBody &_body) {
+  if (!m_fileBody.file) {
+    return false;
+  }
+
+  _body = std::move(m_fileBody);
+  m_fileBody = FileBody();
+  return true;
+}
+
+void ResponseBuilder::SetRangeBody(const uint64_t _size, const std::vector<ByteRange> &_ranges, const std::string &_contentType) {
+  // Ranges are cut from the message, a shared body is only ever sent whole
+  if (m_sharedBody) {
+    m_response.message.assign(m_sharedBody->begin(), m_sharedBody->end());
+    m_sharedBody.reset();
+  }
+
+  Wepp::SetRangeBody(m_response, m_fileBody.file ? &m_fileBody : nullptr, _size, _ranges, _contentType);
+}
+
+void ResponseBuilder::SetCloseConnection(const bool _close) {
+  m_closeConnection = _close;
+}
+
+bool ResponseBuilder::GetCloseConnection() const {
+  return m_closeConnection;
+}
+
+GParsing::HTTPResponse &ResponseBuilder::GetResponse() {
+  return m_response;
+}
+} // namespace Wepp
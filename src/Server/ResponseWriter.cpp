@@ -0,0 +1,96 @@
+#include "Wepp/Server/ResponseWriter.hpp"
+#include "Wepp/Server/HTTPStatus.hpp"
+#include <charconv>
+#include <cstring>
+#include <string>
+
+namespace Wepp {
+static constexpr char s_CRLF[] = "\r\n";
+static constexpr char s_HEADER_SEPARATOR[] = ": ";
+static constexpr char s_VALUE_SEPARATOR[] = ", ";
+
+// Long enough for any int
+static constexpr size_t s_STATUS_CODE_LENGTH = 16;
+
+static size_t FormatStatusCode(const int _code, char *_output) {
+  const std::to_chars_result result = std::to_chars(_output, _output + s_STATUS_CODE_LENGTH, _code);
+  return result.ptr - _output;
+}
+
+static unsigned char *Write(unsigned char *_output, const char *_data, const size_t _length) {
+  std::memcpy(_output, _data, _length);
+  return _output + _length;
+}
+
+static unsigned char *Write(unsigned char *_output, const std::string &_data) {
+  return Write(_output, _data.data(), _data.size());
+}
+
+// The pre-rendered status line when the response uses the standard one
+static const HTTPStatus *StandardStatus(const GParsing::HTTPResponse &_resp) {
+  const HTTPStatus *status = FindHTTPStatus(_resp.response_code);
+  if (!status || _resp.version != "HTTP/1.1" || status->reason != _resp.response_code_message) {
+    return nullptr;
+  }
+
+  return status;
+}
+
+size_t ResponseHeadSize(const GParsing::HTTPResponse &_resp, const std::string_view &_rawHeaders) {
+  const HTTPStatus *status = StandardStatus(_resp);
+  char code[s_STATUS_CODE_LENGTH];
+  size_t output = status ? status->line.size() : _resp.version.size() + 1 + FormatStatusCode(_resp.response_code, code) + 1 + _resp.response_code_message.size() + 2;
+  output += _rawHeaders.size();
+
+  for (const auto &header : _resp.headers) {
+    output += header.first.size() + 2 + 2;
+
+    for (size_t i = 0; i < header.second.size(); i++) {
+      output += header.second[i].size() + (i > 0 ? 2 : 0);
+    }
+  }
+
+  return output + 2;
+}
+
+void AppendResponseHead(const GParsing::HTTPResponse &_resp, std::vector<unsigned char> &_buffer, const std::string_view &_rawHeaders) {
+  const HTTPStatus *status = StandardStatus(_resp);
+
+  const size_t offset = _buffer.size();
+  _buffer.resize(offset + ResponseHeadSize(_resp, _rawHeaders));
+  unsigned char *output = _buffer.data() + offset;
+
+  if (status) {
+    output = Write(output, status->line.data(), status->line.size());
+  } else {
+    char code[s_STATUS_CODE_LENGTH];
+    const size_t codeLength = FormatStatusCode(_resp.response_code, code);
+
+    output = Write(output, _resp.version);
+    *output++ = ' ';
+    output = Write(output, code, codeLength);
+    *output++ = ' ';
+    output = Write(output, _resp.response_code_message);
+    output = Write(output, s_CRLF, 2);
+  }
+
+  output = Write(output, _rawHeaders.data(), _rawHeaders.size());
+
+  for (const auto &header : _resp.headers) {
+    output = Write(output, header.first);
+    output = Write(output, s_HEADER_SEPARATOR, 2);
+
+    for (size_t i = 0; i < header.second.size(); i++) {
+      if (i > 0) {
+        output = Write(output, s_VALUE_SEPARATOR, 2);
+      }
+
+      output = Write(output, header.second[i]);
+    }
+
+    output = Write(output, s_CRLF, 2);
+  }
+
+  Write(output, s_CRLF, 2);
+}
+} // namespace Wepp
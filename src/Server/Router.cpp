@@ -0,0 +1,293 @@
+#include "Wepp/Server/Router.hpp"
+#include "Wepp/Server/HTTPChecks.hpp"
+#include <stdexcept>
+
+namespace Wepp {
+RouteParameters::RouteParameters() : m_count(0) {}
+
+std::string_view RouteParameters::Get(const std::string_view &_name) const {
+  for (size_t i = 0; i < m_count; i++) {
+    if (m_parameters[i].first == _name) {
+      return m_parameters[i].second;
+    }
+  }
+
+  return std::string_view();
+}
+
+size_t RouteParameters::Size() const {
+  return m_count;
+}
+
+void RouteParameters::Push(const std::string_view &_name, const std::string_view &_value) {
+  // Routes with more parameters are refused when they are added
+  m_parameters[m_count++] = {_name, _value};
+}
+
+void RouteParameters::Truncate(const size_t _count) {
+  m_count = _count;
+}
+
+Router::Router() : m_compiled(false) {
+  _NewNode(NODE_STATIC, "");
+}
+
+void Router::Add(const GParsing::HTTPMethod _method, const std::string &_pattern, const WEPP_ROUTE_HANDLER &_handler) {
+  if (m_compiled) {
+    throw std::runtime_error("Route added after the router was compiled: " + _pattern);
+  }
+
+  if (_pattern.empty() || _pattern.front() != '/' || !_handler) {
+    throw std::runtime_error("Invalid route: " + _pattern);
+  }
+
+  size_t node = 0;
+  size_t parameters = 0;
+  size_t start = 0;
+
+  while (start < _pattern.size()) {
+    // Parameters and wildcards only start whole segments
+    size_t special = start;
+    while (special < _pattern.size() && !((_pattern[special] == ':' || _pattern[special] == '*') && _pattern[special - 1] == '/')) {
+      special++;
+    }
+
+    if (special > start) {
+      node = _InsertStatic(node, std::string_view(_pattern).substr(start, special - start));
+    }
+
+    if (special == _pattern.size()) {
+      break;
+    }
+
+    const size_t nameEnd = std::min(_pattern.find('/', special), _pattern.size());
+    const std::string name = _pattern.substr(special + 1, nameEnd - special - 1);
+    const bool wildcard = _pattern[special] == '*';
+
+    if (name.empty() || ++parameters > RouteParameters::s_MAX_PARAMETERS || (wildcard && nameEnd != _pattern.size())) {
+      throw std::runtime_error("Invalid route parameter in " + _pattern);
+    }
+
+    size_t &child = wildcard ? m_nodes[node].wildcardChild : m_nodes[node].parameterChild;
+    if (child == s_NONE) {
+      const size_t created = _NewNode(wildcard ? NODE_WILDCARD : NODE_PARAMETER, name);
+      (wildcard ? m_nodes[node].wildcardChild : m_nodes[node].parameterChild) = created;
+      node = created;
+    } else if (m_nodes[child].text != name) {
+      throw std::runtime_error("Route " + _pattern + " names a parameter differently than an earlier route");
+    } else {
+      node = child;
+    }
+
+    start = nameEnd;
+  }
+
+  if (m_nodes[node].routes[_method] != s_NONE) {
+    throw std::runtime_error("Duplicate route: " + _pattern);
+  }
+
+  m_nodes[node].routes[_method] = m_routes.size();
+  m_routes.push_back({_method, _pattern, _handler});
+}
+
+void Router::Add(const GParsing::HTTPMethod _method, const std::string &_pattern, const WEPP_REQUEST_HANDLER &_handler) {
+  if (!_handler) {
+    throw std::runtime_error("Invalid route: " + _pattern);
+  }
+
+  Add(_method, _pattern, [_handler](const RequestView &_req, const RouteParameters &, ResponseBuilder &_resp) { return _handler(_req, _resp); });
+}
+
+void Router::AddRedirect(const std::string &_pattern, const std::string &_location, const int _status) {
+  Add(GParsing::GPARSING_UNKNOWN, _pattern, [_location, _status](const RequestView &_req, ResponseBuilder &_resp) {
+    const bool closeConnection = !WantsKeepAlive(_req);
+
+    _resp.SetStatus(_status);
+    _resp.AddHeader("Location", _location);
+    _resp.AddHeader("Content-Length", "0");
+    _resp.AddHeader("Connection", closeConnection ? "close" : "keep-alive");
+    _resp.SetCloseConnection(closeConnection);
+    return false;
+  });
+}
+
+void Router::SetNotFoundHandler(const WEPP_REQUEST_HANDLER &_handler) {
+  m_notFoundHandler = _handler;
+}
+
+void Router::Compile() {
+  m_compiled = true;
+}
+
+bool Router::Dispatch(const RequestView &_req, ResponseBuilder &_resp) const {
+  RouteParameters parameters;
+  size_t matched = s_NONE;
+  const std::string_view path = _req.Path();
+
+  if (path.empty() || !_Match(0, path, parameters, matched)) {
+    if (m_notFoundHandler) {
+      return m_notFoundHandler(_req, _resp);
+    }
+
+    _RespondWithoutRoute(_req, _resp, 404, "");
+    return false;
+  }
+
+  const Node &node = m_nodes[matched];
+  size_t route = node.routes[_req.Method()];
+
+  if (route == s_NONE) {
+    route = node.routes[GParsing::GPARSING_UNKNOWN];
+  }
+
+  if (route == s_NONE) {
+    std::string allow;
+    for (size_t method = 0; method < s_METHOD_SLOTS; method++) {
+      if (node.routes[method] != s_NONE) {
+        allow += (allow.empty() ? "" : ", ") + std::string(HTTPMethodName((GParsing::HTTPMethod)method));
+      }
+    }
+
+    _RespondWithoutRoute(_req, _resp, 405, allow);
+    return false;
+  }
+
+  return m_routes[route].handler(_req, parameters, _resp);
+}
+
+WEPP_REQUEST_HANDLER Router::Handler() {
+  Compile();
+
+  return [this](const RequestView &_req, ResponseBuilder &_resp) { return Dispatch(_req, _resp); };
+}
+
+size_t Router::_NewNode(const NodeKind _kind, const std::string &_text) {
+  Node node;
+  node.kind = _kind;
+  node.text = _text;
+  node.parameterChild = s_NONE;
+  node.wildcardChild = s_NONE;
+  node.routes.fill(s_NONE);
+
+  m_nodes.push_back(std::move(node));
+  return m_nodes.size() - 1;
+}
+
+size_t Router::_InsertStatic(size_t _node, std::string_view _text) {
+  while (!_text.empty()) {
+    const size_t child = _FindStaticChild(m_nodes[_node], _text.front());
+
+    if (child == s_NONE) {
+      const size_t created = _NewNode(NODE_STATIC, std::string(_text));
+      m_nodes[_node].children.push_back(created);
+      m_nodes[_node].childBytes.push_back(_text.front());
+      return created;
+    }
+
+    const std::string &prefix = m_nodes[child].text;
+    size_t common = 0;
+    while (common < prefix.size() && common < _text.size() && prefix[common] == _text[common]) {
+      common++;
+    }
+
+    // Split the child so the shared part becomes its own node
+    if (common < prefix.size()) {
+      const size_t split = _NewNode(NODE_STATIC, prefix.substr(0, common));
+      Node &existing = m_nodes[child];
+
+      existing.text.erase(0, common);
+      m_nodes[split].children.push_back(child);
+      m_nodes[split].childBytes.push_back(existing.text.front());
+
+      Node &parent = m_nodes[_node];
+      for (size_t i = 0; i < parent.children.size(); i++) {
+        if (parent.children[i] == child) {
+          parent.children[i] = split;
+        }
+      }
+
+      _node = split;
+    } else {
+      _node = child;
+    }
+
+    _text.remove_prefix(common);
+  }
+
+  return _node;
+}
+
+size_t Router::_FindStaticChild(const Node &_node, const char _first) const {
+  const size_t position = _node.childBytes.find(_first);
+  return position == std::string::npos ? s_NONE : _node.children[position];
+}
+
+bool Router::_Match(const size_t _node, std::string_view _path, RouteParameters &_parameters, size_t &_matched) const {
+  const Node &node = m_nodes[_node];
+  const size_t parameterCount = _parameters.Size();
+
+  switch (node.kind) {
+  case NODE_STATIC:
+    if (_path.compare(0, node.text.size(), node.text) != 0) {
+      return false;
+    }
+
+    _path.remove_prefix(node.text.size());
+    break;
+  case NODE_PARAMETER: {
+    const size_t end = std::min(_path.find('/'), _path.size());
+    if (end == 0) {
+      return false;
+    }
+
+    _parameters.Push(node.text, _path.substr(0, end));
+    _path.remove_prefix(end);
+    break;
+  }
+  default:
+    _parameters.Push(node.text, _path);
+    _path = std::string_view();
+    break;
+  }
+
+  if (_path.empty()) {
+    for (const size_t route : node.routes) {
+      if (route != s_NONE) {
+        _matched = _node;
+        return true;
+      }
+    }
+  } else {
+    // At most one static child can match, its first byte decides
+    const size_t child = _FindStaticChild(node, _path.front());
+    if (child != s_NONE && _Match(child, _path, _parameters, _matched)) {
+      return true;
+    }
+
+    if (node.parameterChild != s_NONE && _Match(node.parameterChild, _path, _parameters, _matched)) {
+      return true;
+    }
+  }
+
+  // Wildcards also match an empty rest
+  if (node.wildcardChild != s_NONE && _Match(node.wildcardChild, _path, _parameters, _matched)) {
+    return true;
+  }
+
+  _parameters.Truncate(parameterCount);
+  return false;
+}
+
+void Router::_RespondWithoutRoute(const RequestView &_req, ResponseBuilder &_resp, const int _status, const std::string &_allow) const {
+  const bool closeConnection = !WantsKeepAlive(_req);
+
+  _resp.SetStatus(_status);
+  if (!_allow.empty()) {
+    _resp.AddHeader("Allow", _allow);
+  }
+
+  _resp.AddHeader("Content-Length", "0");
+  _resp.AddHeader("Connection", closeConnection ? "close" : "keep-alive");
+  _resp.SetCloseConnection(closeConnection);
+}
+} // namespace Wepp
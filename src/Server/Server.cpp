@@ -1,10 +1,22 @@
 #include "Wepp/Server/Server.hpp"
+#include "Wepp/Server/BufferPool.hpp"
+#include "Wepp/Server/HTTPChecks.hpp"
+#include "Wepp/Server/HTTPStatus.hpp"
+#include "Wepp/Server/Metrics.hpp"
+#include "Wepp/Server/ResponseBody.hpp"
+#include "Wepp/Server/ResponseWriter.hpp"
+#include "Wepp/FileHandling/FileIO.hpp"
 #include "GNetworking/Socket.hpp"
 #include "GParsing/GParsing.hpp"
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <climits>
+#include <csignal>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <openssl/err.h>
 #include <openssl/ssl.h>
 #include <stdexcept>
 #include <string>
@@ -12,40 +24,191 @@
 #include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif // !_WIN32
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/sendfile.h>
+#endif // __linux__
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L && !defined(OPENSSL_NO_KTLS)
+#define WEPP_SERVER_KTLS
+#endif // OPENSSL_VERSION_NUMBER
+
 namespace Wepp {
+// Upper bound on how long the loop blocks before re-checking the close flag
+static constexpr int s_WAIT_TIMEOUT_MS = 100;
+
+// Event loop token of the listening socket. Connection handles never reach it.
+static constexpr uint64_t s_LISTENER_TOKEN = UINT64_MAX - 1;
+
+// Opened to hold a descriptor in reserve for each listener
+#ifdef _WIN32
+static constexpr char s_RESERVE_FILE[] = "NUL";
+#else
+static constexpr char s_RESERVE_FILE[] = "/dev/null";
+#endif // _WIN32
+
+// Ready connections that can be queued for the worker pool at once
+static constexpr size_t s_WORK_QUEUE_CAPACITY = 65536;
+
+// First byte of a TLS handshake record
+static constexpr unsigned char s_TLS_HANDSHAKE_RECORD = 0x16;
+
+static constexpr std::chrono::milliseconds s_DEFAULT_KEEP_ALIVE_TIMEOUT(5000);
+static constexpr size_t s_DEFAULT_MAX_KEEP_ALIVE_REQUESTS = 100;
+
+static constexpr std::chrono::milliseconds s_DEFAULT_HANDSHAKE_TIMEOUT(10000);
+static constexpr std::chrono::milliseconds s_DEFAULT_REQUEST_HEADER_TIMEOUT(10000);
+static constexpr std::chrono::milliseconds s_DEFAULT_REQUEST_BODY_TIMEOUT(30000);
+static constexpr std::chrono::milliseconds s_DEFAULT_WRITE_TIMEOUT(30000);
+
+// Resolution of the connection deadlines
+static constexpr std::chrono::milliseconds s_DEADLINE_TICK(10);
+
+// Request framing limits, rejected with 431 and 413
+static constexpr size_t s_DEFAULT_MAX_REQUEST_HEADER_SIZE = 64 * 1024;
+static constexpr uint64_t s_DEFAULT_MAX_REQUEST_BODY_SIZE = 16 * 1024 * 1024;
+
+// Bytes requested from the socket per read
+static constexpr size_t s_READ_CHUNK_SIZE = 16 * 1024;
+
+// Buffers gathered into one write: the queued headers plus the inline body parts behind them
+static constexpr size_t s_MAX_WRITE_VECTORS = 16;
+
+// Largest TLS record payload. Smaller encrypted responses are sent as a single record with their headers.
+static constexpr size_t s_TLS_RECORD_SIZE = 16 * 1024;
+
+// Bounded read size for file bodies that cannot be sent zero-copy
+static constexpr size_t s_FILE_CHUNK_SIZE = 64 * 1024;
+
+// Bytes streamed from a body before the worker yields the connection back to the event loop
+static constexpr uint64_t s_MAX_BODY_BYTES_PER_DISPATCH = 4 * 1024 * 1024;
+
+// Pins the calling thread to one CPU, wrapping around when there are more loops than CPUs
+static void PinCurrentThread(const size_t _index) {
+#ifdef __linux__
+  const unsigned int cpus = std::thread::hardware_concurrency();
+  if (cpus == 0) {
+    return;
+  }
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(_index % cpus, &set);
+
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    WEPP_LOG_WARNING("Cannot pin event loop ", _index, " to a CPU");
+  }
+#else
+  (void)_index;
+#endif // __linux__
+}
+
+// Replaces a header set by the handler where the server has the final say, e.g. Connection and Content-Length
+static void SetResponseHeader(GParsing::HTTPResponse &_resp, const std::string &_name, const std::string &_value) {
+  for (auto &header : _resp.headers) {
+    if (header.first.size() == _name.size() &&
+        std::equal(header.first.begin(), header.first.end(), _name.begin(), [](const char _a, const char _b) { return std::tolower((unsigned char)_a) == std::tolower((unsigned char)_b); })) {
+      header.second = {_value};
+      return;
+    }
+  }
+
+  _resp.headers.push_back({_name, {_value}});
+}
+
 Server::Server(const WEPP_HANDLER_FUNC _handler,
                const WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler,
                const bool _supportNormalHTTP, const size_t &_threadCount)
-    : m_THREAD_COUNT(_threadCount), m_supportHTTP(_supportNormalHTTP),
-      m_handlerFunc(_handler), m_postHandlerFunc(_postHandler) {
-  GetClientSockets().resize(0);
+    : Server(AdaptHandler(_handler), AdaptPostHandler(_postHandler), _supportNormalHTTP, _threadCount) {}
+
+Server::Server(const WEPP_REQUEST_HANDLER &_handler,
+               const WEPP_REQUEST_HANDLER &_postHandler,
+               const bool _supportNormalHTTP, const size_t &_threadCount)
+    : m_supportHTTP(_supportNormalHTTP), m_THREAD_COUNT(_threadCount),
+      m_loopCount(1), m_pinLoopThreads(false),
+      m_keepAliveTimeout(s_DEFAULT_KEEP_ALIVE_TIMEOUT), m_handshakeTimeout(s_DEFAULT_HANDSHAKE_TIMEOUT),
+      m_requestHeaderTimeout(s_DEFAULT_REQUEST_HEADER_TIMEOUT), m_requestBodyTimeout(s_DEFAULT_REQUEST_BODY_TIMEOUT),
+      m_writeTimeout(s_DEFAULT_WRITE_TIMEOUT), m_maxKeepAliveRequests(s_DEFAULT_MAX_KEEP_ALIVE_REQUESTS),
+      m_maxRequestHeaderSize(s_DEFAULT_MAX_REQUEST_HEADER_SIZE), m_maxRequestBodySize(s_DEFAULT_MAX_REQUEST_BODY_SIZE),
+      m_handler(_handler), m_postHandler(_postHandler) {
 }
 
 Server::~Server() {}
 
 void Server::Run(const std::string &_address, const uint16_t _port, std::atomic<bool> &_close) {
-  GLog::Log(GLog::LOG_TRACE, "Starting Server");
+  WEPP_LOG_TRACE("Starting Server");
 
   _Setup(_address, _port);
 
-  _MainLoop(_close);
+  for (auto &loop : m_loops) {
+    LoopContext &context = *loop;
+    context.workerPool.Start([this, &context](ClientSocket &_client) {
+      _HandleOnThread(_client);
+      _CompleteClient(context, _client.handle);
+    });
+  }
+
+  if (m_loops.size() == 1) {
+    if (m_pinLoopThreads) {
+      PinCurrentThread(0);
+    }
+
+    _MainLoop(*m_loops[0], _close);
+  } else {
+    for (auto &loop : m_loops) {
+      LoopContext &context = *loop;
+      context.thread = std::thread([this, &context, &_close]() {
+        if (m_pinLoopThreads) {
+          PinCurrentThread(context.index);
+        }
+
+        _MainLoop(context, _close);
+      });
+    }
+
+    for (auto &loop : m_loops) {
+      loop->thread.join();
+    }
+  }
+
+  for (auto &loop : m_loops) {
+    loop->workerPool.Stop();
+  }
 
   _Cleanup();
 }
 
-void Server::_MainLoop(std::atomic<bool> &_close) {
+void Server::_MainLoop(LoopContext &_loop, std::atomic<bool> &_close) {
+  std::vector<Event> events;
+
   while (!_close) {
-    std::this_thread::sleep_for(std::chrono::microseconds(250));
+    _loop.eventLoop.Wait(events, s_WAIT_TIMEOUT_MS);
 
-    _AcceptConnections();
-    _HandleClients();
-    _CloseConnections();
+    _RearmClients(_loop);
+
+    for (const Event &event : events) {
+      if (event.token == s_LISTENER_TOKEN) {
+        _AcceptConnections(_loop);
+      } else if (event.events & (EVENT_HUP | EVENT_ERROR)) {
+        _CloseConnection(_loop, event.token);
+      } else if (event.events & (EVENT_READ | EVENT_WRITE)) {
+        _DispatchClient(_loop, event.token);
+      }
+    }
+
+    _ExpireDeadlines(_loop);
   }
 }
 
 void Server::_Setup(const std::string &_address, const uint16_t _port) {
   const SSL_METHOD *serverMethod = TLS_server_method();
-  GLog::Log(GLog::LOG_DEBUG, "Server Setup");
+  WEPP_LOG_DEBUG("Server Setup");
   if (GNetworking::SocketSetup() != 0) {
     throw std::runtime_error("Sockets Setup error");
   }
@@ -65,409 +228,1170 @@ void Server::_Setup(const std::string &_address, const uint16_t _port) {
     throw std::runtime_error("Cannot assign ssl.key.pem to SSL context");
   }
 
-  GetServerSocket() = GNetworking::SocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-  if (GetServerSocket() == GNetworkingInvalidSocket) {
+  // Sockets are non-blocking, so SSL_write must be able to return short and be retried from a new offset
+  SSL_CTX_set_mode(m_sslCTX, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+  // Returning clients skip the full handshake
+  m_tlsSessions.Configure(m_sslCTX);
+
+#ifdef SSL_OP_ENABLE_KTLS
+  // Lets file bodies go through SSL_sendfile when the kernel supports TLS offload for the negotiated cipher
+  SSL_CTX_set_options(m_sslCTX, SSL_OP_ENABLE_KTLS);
+#endif // SSL_OP_ENABLE_KTLS
+
+#ifndef _WIN32
+  // Peers closing mid-response must surface as write errors instead of terminating the process
+  std::signal(SIGPIPE, SIG_IGN);
+#endif // !_WIN32
+
+  size_t loopCount = m_loopCount == 0 ? 1 : m_loopCount;
+#ifndef SO_REUSEPORT
+  if (loopCount > 1) {
+    WEPP_LOG_WARNING("SO_REUSEPORT is unavailable, running a single event loop");
+    loopCount = 1;
+  }
+#endif // !SO_REUSEPORT
+
+  // Worker threads are split between the loops
+  const size_t workersPerLoop = (m_THREAD_COUNT + loopCount - 1) / loopCount;
+
+  m_loops.clear();
+  for (size_t i = 0; i < loopCount; i++) {
+    m_loops.emplace_back(new LoopContext(i, workersPerLoop, s_WORK_QUEUE_CAPACITY, s_DEADLINE_TICK));
+    _SetupListener(*m_loops.back(), _address, _port, loopCount > 1);
+  }
+
+  WEPP_LOG_DEBUG(loopCount, " event loop(s), backend: ", m_loops[0]->eventLoop.GetBackendName());
+}
+
+void Server::_SetupListener(LoopContext &_loop, const std::string &_address, const uint16_t _port, const bool _reusePort) {
+  _loop.listener = GNetworking::SocketCreate(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (_loop.listener == GNetworkingInvalidSocket) {
     throw std::runtime_error("Cannot create server socket");
   }
 
   int value = 1;
-  if (GNetworking::SocketSetOption(GetServerSocket(), SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)) != 0) {
+  if (GNetworking::SocketSetOption(_loop.listener, SOL_SOCKET, SO_REUSEADDR, &value, sizeof(value)) != 0) {
     throw std::runtime_error("Cannot set socket option SO_REUSEADDR");
   }
 
-  if (GNetworking::SocketBind(GetServerSocket(), _address, _port) != 0) {
+#ifdef SO_REUSEPORT
+  // Every loop binds its own listener to the same port and the kernel spreads new connections between them
+  if (_reusePort && GNetworking::SocketSetOption(_loop.listener, SOL_SOCKET, SO_REUSEPORT, &value, sizeof(value)) != 0) {
+    throw std::runtime_error("Cannot set socket option SO_REUSEPORT");
+  }
+#endif // SO_REUSEPORT
+
+  if (GNetworking::SocketBind(_loop.listener, _address, _port) != 0) {
     throw std::runtime_error("Cannot bind server socket to address");
   }
 
-  if (GNetworking::SocketListen(GetServerSocket()) != 0) {
+  if (GNetworking::SocketListen(_loop.listener) != 0) {
     throw std::runtime_error("Cannot liston on binded server socket");
   }
+
+  // Edge triggered, so every readiness notification must drain the accept queue
+  if (!SetSocketNonBlocking(_loop.listener)) {
+    throw std::runtime_error("Cannot set server socket to non-blocking");
+  }
+
+  if (!_loop.eventLoop.Add(_loop.listener, EVENT_READ | EVENT_EDGE, s_LISTENER_TOKEN)) {
+    throw std::runtime_error("Cannot register server socket with event loop");
+  }
+
+  _loop.reserveFD = OpenFileDescriptor(s_RESERVE_FILE);
+  if (_loop.reserveFD < 0) {
+    WEPP_LOG_WARNING("Cannot open a reserve descriptor, connections wait in the queue when descriptors run out");
+  }
 }
 
 void Server::_Cleanup() {
   int result;
-  GLog::Log(GLog::LOG_DEBUG, "Server Cleanup");
+  WEPP_LOG_DEBUG("Server Cleanup");
 
-  result = GNetworking::SocketShutdown(GetServerSocket(), GNetworkingSHUTDOWNRDWR);
-  if (result != 0) {
-    GLog::Log(GLog::LOG_WARNING, "Server socket shutdown unsuccessful: " + std::to_string(result));
-    // throw std::runtime_error("Server socket shutdown error: " + std::to_string(result));
-  }
+  for (auto &loop : m_loops) {
+    loop->eventLoop.Remove(loop->listener);
 
-  result = GNetworking::SocketClose(GetServerSocket());
-  if (result != 0) {
-    GLog::Log(GLog::LOG_WARNING, "Server socket close unsuccessful: " + std::to_string(result));
-    // throw std::runtime_error("Server socket close error: " + std::to_string(result));
+    std::vector<ConnectionHandle> connections;
+    connections.reserve(loop->connections.Size());
+    loop->connections.ForEach([&connections](const ClientSocket &_client) { connections.push_back(_client.handle); });
+
+    for (const ConnectionHandle connection : connections) {
+      _CloseConnection(*loop, connection);
+    }
+
+    result = GNetworking::SocketShutdown(loop->listener, GNetworkingSHUTDOWNRDWR);
+    if (result != 0) {
+      WEPP_LOG_WARNING("Server socket shutdown unsuccessful: ", result);
+      // throw std::runtime_error("Server socket shutdown error: " + std::to_string(result));
+    }
+
+    result = GNetworking::SocketClose(loop->listener);
+    if (result != 0) {
+      WEPP_LOG_WARNING("Server socket close unsuccessful: ", result);
+      // throw std::runtime_error("Server socket close error: " + std::to_string(result));
+    }
+
+    CloseFileDescriptor(loop->reserveFD);
+    loop->reserveFD = -1;
   }
 
   result = GNetworking::SocketCleanup();
   if (result != 0) {
-    GLog::Log(GLog::LOG_WARNING, "Socket cleanup unsuccessful: " + std::to_string(result));
+    WEPP_LOG_WARNING("Socket cleanup unsuccessful: ", result);
     // throw std::runtime_error("Sockets cleanup error: " + std::to_string(result));
   }
 
   SSL_CTX_free(m_sslCTX);
 }
 
-void Server::_AcceptConnections() {
-  GParsing::HTTPRequest req;
-  std::vector<unsigned char> buffer;
+void Server::_AcceptConnections(LoopContext &_loop) {
+  GNetworking::GNetworkingSocket socket;
+
+  // The listener is edge triggered, so this only stops once the queue is empty or accepting itself fails
+  while (true) {
+    socket = GNetworking::SocketAccept(_loop.listener);
+    if (socket != GNetworkingInvalidSocket) {
+      const auto started = std::chrono::steady_clock::now();
+      _AcceptConnection(_loop, socket);
+      RecordLatency(PHASE_ACCEPT, std::chrono::steady_clock::now() - started);
+      continue;
+    }
+
+    switch (LastAcceptError()) {
+    case ACCEPT_RETRY:
+      continue;
+    case ACCEPT_DRAINED:
+      return;
+    case ACCEPT_NO_DESCRIPTORS:
+      if (!_ShedConnection(_loop)) {
+        return;
+      }
+
+      continue;
+    case ACCEPT_FAILED:
+      WEPP_LOG_WARNING("Accepting a connection failed, waiting for the next one");
+      return;
+    }
+  }
+}
+
+bool Server::_ShedConnection(LoopContext &_loop) {
+  // Without a spare descriptor the queued connections wait until one is closed and a new arrival wakes the loop
+  if (_loop.reserveFD < 0) {
+    WEPP_LOG_WARNING("Out of file descriptors, cannot accept connections");
+    return false;
+  }
+
+  // Frees one descriptor to take the connection off the queue and refuse it, instead of leaving it to time out
+  CloseFileDescriptor(_loop.reserveFD);
+  const GNetworking::GNetworkingSocket socket = GNetworking::SocketAccept(_loop.listener);
+  const bool drained = socket == GNetworkingInvalidSocket && LastAcceptError() == ACCEPT_DRAINED;
+
+  if (socket != GNetworkingInvalidSocket) {
+    WEPP_LOG_WARNING("Out of file descriptors, refused a connection");
+    CountMetric(COUNTER_CONNECTIONS_REJECTED);
+    GNetworking::SocketClose(socket);
+  }
+
+  _loop.reserveFD = OpenFileDescriptor(s_RESERVE_FILE);
+  return !drained;
+}
+
+void Server::_AcceptConnection(LoopContext &_loop, const GNetworking::GNetworkingSocket _socket) {
   SSL *connection;
-  int output;
-  size_t pollSize;
-  std::string hostValue;
-  char c;
+  PeerAddress peer;
+
+  // Refused before any state is allocated. The reset skips TIME_WAIT, so a flood leaves nothing behind.
+  if (!m_admission.TryAdmit(_socket, peer)) {
+    WEPP_LOG_DEBUG('[', _socket, "]: Connection limit reached, refusing connection");
+    CountMetric(COUNTER_CONNECTIONS_REJECTED);
 
-  // Poll for new connections
-  if (!GNetworking::SocketPoll(GetServerSocket(), GNetworkingPOLLIN)) {
+    const linger reset = {1, 0};
+    GNetworking::SocketSetOption(_socket, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+    GNetworking::SocketClose(_socket);
     return;
   }
 
-  connection = SSL_new(m_sslCTX);
-  SSL_set_fd(connection, GNetworking::SocketAccept(GetServerSocket()));
-  GLog::Log(GLog::LOG_DEBUG, "Opened Connection on Socket FD: " + std::to_string(SSL_get_fd(connection)));
-
-  std::this_thread::sleep_for(std::chrono::microseconds(2500));
+  if (!SetSocketNonBlocking(_socket)) {
+    WEPP_LOG_WARNING('[', _socket, "]: Cannot set socket to non-blocking");
+    GNetworking::SocketClose(_socket);
+    m_admission.Release(peer);
+    return;
+  }
 
-  pollSize = GNetworking::SocketPollSize(SSL_get_fd(connection));
+  connection = SSL_new(m_sslCTX);
+  SSL_set_fd(connection, _socket);
+  SSL_set_accept_state(connection);
+  WEPP_LOG_DEBUG("Opened Connection on Socket FD: ", _socket);
+
+  // Protocol detection and the TLS handshake happen on a worker once the first bytes arrive
+  ClientSocket client(connection, false);
+  client.peer = peer;
+
+  const ConnectionHandle handle = _loop.connections.Insert(std::move(client));
+  CountMetric(COUNTER_CONNECTIONS_ACCEPTED);
+  _ScheduleDeadline(_loop, *_loop.connections.Find(handle));
+
+  // Level triggered so shutdown sockets keep reporting HUP. One shot so a socket is only ever handed
+  // to one worker at a time; it is re-armed once the worker reports it complete.
+  if (!_loop.eventLoop.Add(_socket, EVENT_READ | EVENT_ONESHOT, handle)) {
+    WEPP_LOG_WARNING('[', _socket, "]: Failed to register socket with event loop");
+    _CloseConnection(_loop, handle);
+  }
+}
 
-  if (pollSize <= 0)
-  {
-    GetClientSockets().push_back({ connection, false });
-    GNetworking::SocketShutdown(SSL_get_fd(connection), GNetworkingSHUTDOWNRDWR);
+void Server::_DispatchClient(LoopContext &_loop, const ConnectionHandle _handle) {
+  ClientSocket *client = _loop.connections.Find(_handle);
+  if (!client) {
     return;
   }
 
-  buffer.resize(pollSize);
-  GNetworking::SocketPeek(SSL_get_fd(connection), (char *)buffer.data(), buffer.size(), 0);
+  client->dispatched = true;
 
-  // Test if using normal HTTP or HTTPS
-  try {
-    // For HTTP
-    req.ParseRequest(buffer);
-  } catch (const std::exception &) {
-    // For HTTPS
-    output = SSL_accept(connection);
-    GLog::Log(GLog::LOG_DEBUG, '[' + std::to_string(SSL_get_fd(connection)) + "]: SSL handshake attempt output: " + std::to_string(output));
+  if (!_loop.workerPool.Submit(client)) {
+    WEPP_LOG_WARNING("Worker queue full. Handling client on event loop thread.");
+    _HandleOnThread(*client);
+    client->dispatched = false;
 
-    // Successfull SSL connection
-    if (output >= 0) {
-      GetClientSockets().push_back({connection, true});
-      return;
+    if (client->state == CLIENT_CLOSING) {
+      _CloseConnection(_loop, _handle);
     } else {
-      GLog::Log(GLog::LOG_WARNING, "SSL handshake failed. Unknown Packet.");
+      _loop.eventLoop.Modify(SSL_get_fd(client->socket), client->interest | EVENT_ONESHOT, _handle);
+      _ScheduleDeadline(_loop, *client);
+    }
+  }
+}
 
-      buffer.push_back('\0');
-      GLog::Log(GLog::LOG_TRACE, (char *)buffer.data());
+void Server::_CompleteClient(LoopContext &_loop, const ConnectionHandle _handle) {
+  while (!_loop.completedSockets.TryPush(_handle)) {
+    _loop.eventLoop.Wake();
+    std::this_thread::yield();
+  }
 
-      GetClientSockets().push_back({connection, true});
-      GNetworking::SocketShutdown(SSL_get_fd(connection), GNetworkingSHUTDOWNRDWR);
-      return;
+  _loop.eventLoop.Wake();
+}
+
+void Server::_RearmClients(LoopContext &_loop) {
+  ConnectionHandle handle;
+
+  while (_loop.completedSockets.TryPop(handle)) {
+    ClientSocket *client = _loop.connections.Find(handle);
+    if (!client) {
+      continue;
+    }
+
+    client->dispatched = false;
+
+    if (client->state == CLIENT_CLOSING) {
+      _CloseConnection(_loop, handle);
+    } else {
+      _loop.eventLoop.Modify(SSL_get_fd(client->socket), client->interest | EVENT_ONESHOT, handle);
+      _ScheduleDeadline(_loop, *client);
     }
   }
+}
+
+void Server::_CloseConnection(LoopContext &_loop, const ConnectionHandle _handle) {
+  ClientSocket *client = _loop.connections.Find(_handle);
+  if (!client) {
+    return;
+  }
+
+  const GNetworking::GNetworkingSocket socket = SSL_get_fd(client->socket);
+  const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - client->connectedAt);
+
+  _loop.eventLoop.Remove(socket);
+  WEPP_LOG_DEBUG("Closing Socket FD: ", socket, " after ", duration.count(), "ms, ", client->requestsServed, " requests, ", client->bytesReceived, " bytes in, ", client->bytesSent, " bytes out");
+
+  // Without a close_notify OpenSSL drops the session from the cache and clients see a truncated connection they will not resume.
+  // Best effort: the socket is non-blocking and the peer's reply is not waited for.
+  if (client->encrypted && SSL_is_init_finished(client->socket)) {
+    ERR_clear_error();
+    SSL_shutdown(client->socket);
+  }
+
+  GNetworking::SocketShutdown(socket, GNetworkingSHUTDOWNRDWR);
+  GNetworking::SocketClose(socket);
+  client->body.Clear();
+  SSL_free(client->socket);
+  m_admission.Release(client->peer);
+  _loop.connections.Remove(_handle);
+  CountMetric(COUNTER_CONNECTIONS_CLOSED);
+  WEPP_LOG_DEBUG("Amount of active sockets on loop ", _loop.index, ": ", _loop.connections.Size());
+}
 
-  // Using HTTP Connection
-  if (m_supportHTTP) {
-    // Stay on HTTP
-    GLog::Log(GLog::LOG_DEBUG, '[' + std::to_string(SSL_get_fd(connection)) + "]: HTTP Detected. Continuing on HTTP.");
-    GetClientSockets().push_back({connection, false});
+void Server::_ScheduleDeadline(LoopContext &_loop, ClientSocket &_client) {
+  if (_client.state == CLIENT_DETECTING || _client.state == CLIENT_HANDSHAKING) {
+    _client.deadline = _client.connectedAt + m_handshakeTimeout;
+    _client.deadlineReason = TIMEOUT_HANDSHAKE;
+  } else if (_client.HasPendingSend()) {
+    _client.deadline = _client.lastActivity + m_writeTimeout;
+    _client.deadlineReason = TIMEOUT_WRITE;
+  } else if (_client.recvBuffer.empty()) {
+    _client.deadline = _client.lastActivity + m_keepAliveTimeout;
+    _client.deadlineReason = TIMEOUT_IDLE;
+  } else if (!_client.parser.HeadersComplete()) {
+    // Fixed from the first byte, so trickling a byte at a time does not keep a connection open
+    _client.deadline = _client.requestStarted + m_requestHeaderTimeout;
+    _client.deadlineReason = TIMEOUT_REQUEST_HEADER;
   } else {
-    // Redirect to HTTPS
-    GetClientSockets().push_back({connection, true});
-    GParsing::HTTPResponse redirectResponse;
-
-    GLog::Log(GLog::LOG_DEBUG, '[' + std::to_string(SSL_get_fd(connection)) + "]: HTTP Detected. Redirecting to HTTPS.");
-    for (const auto &header : req.headers) {
-      if (header.first == "Host") {
-        if (header.second.size() != 1) {
-          break;
-        } else {
-          hostValue = header.second[0];
-        }
-      }
+    _client.deadline = _client.lastActivity + m_requestBodyTimeout;
+    _client.deadlineReason = TIMEOUT_REQUEST_BODY;
+  }
+
+  // A queued expiry at or before the new deadline is enough, it re-queues the connection when it fires early
+  if (_client.timerExpiry == std::chrono::steady_clock::time_point() || _client.deadline < _client.timerExpiry) {
+    _loop.deadlines.Schedule(_client.handle, _client.deadline);
+    _client.timerExpiry = _client.deadline;
+  }
+}
+
+void Server::_ExpireDeadlines(LoopContext &_loop) {
+  const auto now = std::chrono::steady_clock::now();
+
+  _loop.expired.clear();
+  _loop.deadlines.Advance(now, _loop.expired);
+
+  for (const ConnectionHandle handle : _loop.expired) {
+    ClientSocket *client = _loop.connections.Find(handle);
+    if (!client) {
+      continue;
     }
 
-    if (hostValue != "") {
-      const std::string findHTTP = "http://";
-      if (hostValue.find(findHTTP) == 0) {
-        hostValue.replace(0, findHTTP.length(), "https://");
-      } else if (hostValue.find('/') == 0) {
-        hostValue.insert(0, "https:/");
-      } else {
-        hostValue.insert(0, "https://");
-      }
+    client->timerExpiry = std::chrono::steady_clock::time_point();
+
+    // Sockets owned by a worker get a new deadline when they are handed back
+    if (client->dispatched) {
+      continue;
+    }
 
-      redirectResponse.response_code = 301;
-      redirectResponse.response_code_message = "Moved Permanently";
-      redirectResponse.headers.push_back({"Location", {hostValue}});
-      redirectResponse.headers.push_back({ "Connection", {"close"} });
-      redirectResponse.version = "HTTP/1.1";
-      redirectResponse.message.clear();
-      auto respBuffer = redirectResponse.CreateResponse();
-      respBuffer.push_back('\0');
+    if (client->deadline > now) {
+      _loop.deadlines.Schedule(handle, client->deadline);
+      client->timerExpiry = client->deadline;
+      continue;
+    }
 
-      GLog::Log(GLog::LOG_TRACE, (std::string)"Redirect HTTP response: \n" + (char *)respBuffer.data());
-      GLog::Log(GLog::LOG_DEBUG, '[' + std::to_string(SSL_get_fd(connection)) + "]: Redirecting to " + hostValue + '.');
-      _SendBuffer(connection, respBuffer, true);
+    switch (client->deadlineReason) {
+    case TIMEOUT_HANDSHAKE:
+      WEPP_LOG_DEBUG("Closing connection that did not complete its handshake in time");
+      CountMetric(COUNTER_HANDSHAKE_TIMEOUTS);
+      break;
+    case TIMEOUT_REQUEST_HEADER:
+    case TIMEOUT_REQUEST_BODY:
+      WEPP_LOG_DEBUG("Closing connection that did not send its request in time");
+      CountMetric(COUNTER_READ_TIMEOUTS);
+      break;
+    case TIMEOUT_WRITE:
+      WEPP_LOG_DEBUG("Closing connection that stopped reading its response");
+      CountMetric(COUNTER_WRITE_TIMEOUTS);
+      break;
+    default:
+      WEPP_LOG_DEBUG("Closing idle connection");
+      CountMetric(COUNTER_IDLE_TIMEOUTS);
+      break;
     }
 
-    // This is buggy and I don't know why
-    GNetworking::SocketShutdown(SSL_get_fd(connection), GNetworkingSHUTDOWNRDWR);
+    _CloseConnection(_loop, handle);
   }
 }
 
-void Server::_HandleClients() {
-  WEPP_HANDLER_FUNC handlerFunc = m_handlerFunc;
-  WEPP_POST_HANDLER_SUCCESS_FUNC postHandlerFunc = m_postHandlerFunc;
+void Server::_HandleOnThread(ClientSocket &_client) {
+  _ServeClient(_client);
+
+  // Idle connections keep no buffer memory until their next request. Partially sent responses keep theirs.
+  BufferPool &pool = BufferPool::Local();
+  pool.Release(_client.recvBuffer);
+  pool.Release(_client.sendBuffer);
+}
+
+void Server::_ServeClient(ClientSocket &_client) {
+  _client.interest = EVENT_READ;
+
+  if (_client.state == CLIENT_DETECTING && !_DetectProtocol(_client)) {
+    return;
+  }
+
+  if (_client.state == CLIENT_HANDSHAKING && !_ContinueHandshake(_client)) {
+    return;
+  }
+
+  if (_client.state != CLIENT_ACTIVE) {
+    return;
+  }
 
-  std::vector<std::thread> threadPool(m_THREAD_COUNT);
-  size_t threadIndex = 0;
+  // Finish any response that was cut short by a full socket buffer before reading more
+  if (!_FlushSendBuffer(_client) || _client.HasPendingSend() || _client.state != CLIENT_ACTIVE) {
+    return;
+  }
+
+  _HandleRequest(_client);
+}
+
+bool Server::_DetectProtocol(ClientSocket &_client) {
+  const GNetworking::GNetworkingSocket clientSocket = SSL_get_fd(_client.socket);
+  unsigned char firstByte;
   int output;
 
-  // Poll for reading on clients
-  for (size_t i = 0; i < GetClientSockets().size(); i++) {
-    if (GNetworking::SocketPoll(SSL_get_fd(GetClientSockets()[i].socket), GNetworkingPOLLHUP)) {
-      GNetworking::SocketShutdown(SSL_get_fd(GetClientSockets()[i].socket), GNetworkingSHUTDOWNRDWR);
-    }
+  output = GNetworking::SocketPeek(clientSocket, (char *)&firstByte, sizeof(firstByte), 0);
 
-    if (GNetworking::SocketPoll(SSL_get_fd(GetClientSockets()[i].socket), GNetworkingPOLLIN)) {
-      threadIndex = i % m_THREAD_COUNT;
+  if (output < 0 && SocketWouldBlock()) {
+    return false;
+  }
 
-      // Cleanup running thread in pool
-      if (threadPool[threadIndex].joinable()) {
-        threadPool[threadIndex].join();
-      }
+  if (output <= 0) {
+    WEPP_LOG_DEBUG('[', clientSocket, "]: Connection closed before sending data");
+    _client.state = CLIENT_CLOSING;
+    return false;
+  }
 
-      // Create new thread
-      threadPool[threadIndex] = std::thread(&Server::_HandleOnThread, this, GetClientSockets()[i], handlerFunc, postHandlerFunc);
-    }
+  if (firstByte == s_TLS_HANDSHAKE_RECORD) {
+    WEPP_LOG_DEBUG('[', clientSocket, "]: TLS Detected. Starting handshake.");
+    _client.encrypted = true;
+    _client.state = CLIENT_HANDSHAKING;
+    _client.handshakeStarted = std::chrono::steady_clock::now();
+  } else {
+    WEPP_LOG_DEBUG('[', clientSocket, "]: HTTP Detected.");
+    _client.encrypted = false;
+    _client.state = CLIENT_ACTIVE;
   }
 
-  for (size_t i = 0; i < m_THREAD_COUNT; i++) {
-    if (threadPool[i].joinable()) {
-      GLog::Log(GLog::LOG_TRACE, "Joining thread - " + std::to_string(i));
-      threadPool[i].join();
-    }
+  return true;
+}
+
+bool Server::_ContinueHandshake(ClientSocket &_client) {
+  int output;
+
+  ERR_clear_error();
+  output = SSL_accept(_client.socket);
+
+  if (output == 1) {
+    WEPP_LOG_DEBUG('[', SSL_get_fd(_client.socket), "]: SSL handshake complete. Resumed: ", SSL_session_reused(_client.socket));
+    m_tlsSessions.RecordHandshake(_client.socket);
+    RecordLatency(PHASE_HANDSHAKE, std::chrono::steady_clock::now() - _client.handshakeStarted);
+    _client.state = CLIENT_ACTIVE;
+    return true;
+  }
+
+  switch (SSL_get_error(_client.socket, output)) {
+  case SSL_ERROR_WANT_READ:
+    _client.interest = EVENT_READ;
+    return false;
+  case SSL_ERROR_WANT_WRITE:
+    _client.interest = EVENT_WRITE;
+    return false;
+  default:
+    WEPP_LOG_WARNING('[', SSL_get_fd(_client.socket), "]: SSL handshake failed. Output: ", output);
+    CountMetric(COUNTER_HANDSHAKES_FAILED);
+    _client.state = CLIENT_CLOSING;
+    return false;
   }
 }
 
-void Server::_CloseConnections() {
-  GNetworking::GNetworkingSocket sock;
+void Server::_HandleRequest(ClientSocket &_client) {
+  RequestView request;
+  GNetworking::GNetworkingSocket clientSocket = SSL_get_fd(_client.socket);
+  size_t readSize;
+
+  // Serve every complete pipelined request, in order, until a response has to wait for the socket to drain.
+  // Only read more once the buffered bytes hold no complete request.
+  while (_client.state == CLIENT_ACTIVE && !_client.HasPendingSend()) {
+    const auto parseStarted = std::chrono::steady_clock::now();
+
+    switch (_client.parser.Parse(_client.recvBuffer, m_maxRequestHeaderSize, m_maxRequestBodySize)) {
+    case PARSE_ERROR:
+      WEPP_LOG_WARNING('[', clientSocket, "]: Rejecting request with status ", _client.parser.ErrorStatus());
+      CountMetric(COUNTER_REQUESTS_REJECTED);
+      _RejectRequest(_client, _client.parser.ErrorStatus());
+      return;
+    case PARSE_COMPLETE: {
+      const size_t requestSize = _client.parser.RequestSize();
+      const size_t consumed = _client.parser.ConsumedSize();
+      _client.parser.Reset();
+
+      // Handled in place. The bytes are only dropped once the request has been answered.
+      _ProcessRequest(_client, request, _client.recvBuffer.data(), requestSize, parseStarted);
 
-  // Poll for closing sockets
-  for (int32_t i = GetClientSockets().size() - 1; i >= 0; i--) {
-    sock = SSL_get_fd(GetClientSockets()[i].socket);
+      // A rejected request has already cleared the buffer
+      _client.recvBuffer.erase(_client.recvBuffer.begin(), _client.recvBuffer.begin() + std::min(consumed, _client.recvBuffer.size()));
+
+      // The header deadline of a pipelined request starts once the one before it is answered
+      _client.requestStarted = std::chrono::steady_clock::now();
+      break;
+    }
+    case PARSE_INCOMPLETE:
+      if (!_ReadBuffer(_client, readSize)) {
+        WEPP_LOG_DEBUG('[', clientSocket, "]: Connection closed by peer or read failed");
+        _client.state = CLIENT_CLOSING;
+        return;
+      }
+
+      // Nothing more until the socket is readable again
+      if (readSize == 0) {
+        return;
+      }
 
-    if (GNetworking::SocketPoll(sock, GNetworkingPOLLHUP)) {
-      GLog::Log(GLog::LOG_DEBUG,
-                "Closing Socket FD: " +
-                    std::to_string(SSL_get_fd(GetClientSockets()[i].socket)));
-      GNetworking::SocketShutdown(sock, GNetworkingSHUTDOWNRDWR);
-      GNetworking::SocketClose(sock);
-      SSL_free(GetClientSockets()[i].socket);
-      GetClientSockets().erase(GetClientSockets().begin() + i);
-      GLog::Log(GLog::LOG_DEBUG, "Amount of active sockets: " +
-                                     std::to_string(GetClientSockets().size()));
+      break;
     }
   }
 }
 
-size_t Server::_FindReadSize(const ClientSocket&_client) {
-  constexpr size_t PEEK_INCREMENT = 512;
-  int32_t recvSize = 0;
-  int32_t recvOutput = recvSize;
-  std::vector<unsigned char> buffer;
+void Server::_ProcessRequest(ClientSocket &_client, RequestView &_request, const unsigned char *_data, const size_t _size, const std::chrono::steady_clock::time_point &_parseStarted) {
+  GParsing::HTTPResponse resp;
+  GParsing::HTTPResponse intermediateResp;
+  ResponseBuilder response(resp);
+  GNetworking::GNetworkingSocket clientSocket = SSL_get_fd(_client.socket);
 
-  if (GNetworking::SocketPoll(SSL_get_fd(_client.socket), GNetworkingPOLLHUP)) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: Failed to peek on socket");
-    GNetworking::SocketShutdown(SSL_get_fd(_client.socket),
-                                GNetworkingSHUTDOWNRDWR);
-    return 0;
+  // Views into the receive buffer, nothing is copied on the way to the handler
+  if (!_request.Parse(_data, _size)) {
+    WEPP_LOG_WARNING('[', clientSocket, "]: Malformed request line or header");
+    CountMetric(COUNTER_REQUESTS_REJECTED);
+    _RejectRequest(_client, 400);
+    return;
   }
 
-  while (recvOutput >= recvSize) {
-    recvSize += PEEK_INCREMENT;
-    buffer.resize(recvSize);
-    m_mutex.lock();
-    if (_client.encrypted) {
-      recvOutput = SSL_peek(_client.socket, buffer.data(), buffer.size());
-    } else {
-      recvOutput = GNetworking::SocketPeek(SSL_get_fd(_client.socket), (char *)buffer.data(), buffer.size(), 0);
-    }
-    m_mutex.unlock();
+  WEPP_LOG_TRACE(std::string(_request.Raw()));
+  RecordLatency(PHASE_PARSE, std::chrono::steady_clock::now() - _parseStarted);
+  CountMetric(COUNTER_REQUESTS);
+
+  if (!_client.encrypted && !m_supportHTTP) {
+    _RedirectToHTTPS(_client, _request);
+    return;
   }
 
-  GLog::Log(GLog::LOG_TRACE, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: Peeked " + std::to_string(recvOutput) + " bytes on socket");
-  if (recvOutput <= 0) {
-    return 0;
+  if (_IsMetricsRequest(_request)) {
+    response.SetCloseConnection(!WantsKeepAlive(_request));
+    _ServeMetrics(_request, resp, response.GetCloseConnection());
   } else {
-    return recvOutput;
+    WEPP_LOG_TRACE('[', clientSocket, "]: Sending request to handler");
+    const auto handlerStarted = std::chrono::steady_clock::now();
+
+    if (m_handler(_request, response)) {
+      WEPP_LOG_TRACE('[', clientSocket, "]: Request successful, sending to post handler");
+      ResponseBuilder intermediate(intermediateResp);
+
+      if (m_postHandler && m_postHandler(_request, intermediate)) {
+        WEPP_LOG_TRACE('[', clientSocket, "]: Post handler successful, sending to client");
+        _QueueResponse(_client, intermediateResp, false);
+      }
+    }
+
+    RecordLatency(PHASE_HANDLER, std::chrono::steady_clock::now() - handlerStarted);
+  }
+
+  if (!_AttachFileBody(_client, resp, response)) {
+    WEPP_LOG_WARNING('[', clientSocket, "]: Could not attach file body");
+  }
+
+  // RFC 9110 9.3.2: HEAD gets the headers a GET would, Content-Length included, but never a body.
+  // Sending one anyway would be read as the start of the next response on a persistent connection.
+  if (_request.Method() == GParsing::GPARSING_HEAD) {
+    resp.message.clear();
+    _client.body.Clear();
+  }
+
+  bool closeConnection = response.GetCloseConnection();
+
+  _client.requestsServed++;
+  if (!closeConnection && _client.requestsServed >= m_maxKeepAliveRequests) {
+    closeConnection = true;
+    SetResponseHeader(resp, "Connection", "close");
+  }
+
+  // The interim response, headers and body all leave in as few writes as possible
+  _client.sendStarted = std::chrono::steady_clock::now();
+  _QueueResponse(_client, resp, closeConnection, response.GetRawHeaders());
+  if (!_FlushSendBuffer(_client)) {
+    WEPP_LOG_WARNING('[', clientSocket, "]: Response send failed");
+    _client.state = CLIENT_CLOSING;
   }
 }
 
-bool Server::_ReadBuffer(const ClientSocket&_client, std::vector<unsigned char> &_buffer) {
-  if (GNetworking::SocketPoll(SSL_get_fd(_client.socket), GNetworkingPOLLHUP)) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: Failed to read on socket");
-    GNetworking::SocketShutdown(SSL_get_fd(_client.socket), GNetworkingSHUTDOWNRDWR);
+bool Server::_IsMetricsRequest(const RequestView &_req) const {
+  if (m_metricsPath.empty() || (_req.Method() != GParsing::GPARSING_GET && _req.Method() != GParsing::GPARSING_HEAD)) {
     return false;
   }
 
-  m_mutex.lock();
+  // The query string is ignored
+  const std::string_view target = _req.Target();
+  return target.compare(0, m_metricsPath.size(), m_metricsPath) == 0 && (target.size() == m_metricsPath.size() || target[m_metricsPath.size()] == '?');
+}
+
+void Server::_ServeMetrics(const RequestView &_req, GParsing::HTTPResponse &_resp, const bool _closeConnection) {
+  const TLSSessionStats tls = m_tlsSessions.GetStats();
+  std::string body;
+
+  RenderMetrics(body);
+  body += "# HELP wepp_tls_handshakes_total Completed TLS handshakes\n# TYPE wepp_tls_handshakes_total counter\n";
+  body += "wepp_tls_handshakes_total{resumed=\"false\"} " + std::to_string(tls.fullHandshakes) + '\n';
+  body += "wepp_tls_handshakes_total{resumed=\"true\"} " + std::to_string(tls.resumedHandshakes) + '\n';
+
+  SetResponseStatus(_resp, 200);
+  _resp.headers.push_back({"Content-Type", {"text/plain; version=0.0.4; charset=utf-8"}});
+  _resp.headers.push_back({"Content-Length", {std::to_string(body.size())}});
+  _resp.headers.push_back({"Connection", {_closeConnection ? "close" : "keep-alive"}});
+
+  if (_req.Method() == GParsing::GPARSING_GET) {
+    _resp.message.assign(body.begin(), body.end());
+  }
+}
+
+void Server::_RedirectToHTTPS(ClientSocket &_client, const RequestView &_req) {
+  GParsing::HTTPResponse redirectResponse;
+  std::string hostValue;
+
+  WEPP_LOG_DEBUG('[', SSL_get_fd(_client.socket), "]: HTTP Detected. Redirecting to HTTPS.");
+  size_t hostValues = 0;
+
+  _req.ForEachValue(HEADER_HOST, [&hostValue, &hostValues](const std::string_view &_value) {
+    hostValue = _value;
+    hostValues++;
+  });
+
+  // Ambiguous without exactly one value
+  if (hostValues != 1) {
+    hostValue.clear();
+  }
+
+  if (hostValue == "") {
+    _client.state = CLIENT_CLOSING;
+    return;
+  }
+
+  const std::string findHTTP = "http://";
+  if (hostValue.find(findHTTP) == 0) {
+    hostValue.replace(0, findHTTP.length(), "https://");
+  } else if (hostValue.find('/') == 0) {
+    hostValue.insert(0, "https:/");
+  } else {
+    hostValue.insert(0, "https://");
+  }
+
+  SetResponseStatus(redirectResponse, 301);
+  redirectResponse.headers.push_back({"Location", {hostValue}});
+  redirectResponse.headers.push_back({ "Connection", {"close"} });
+  redirectResponse.message.clear();
+
+  WEPP_LOG_DEBUG('[', SSL_get_fd(_client.socket), "]: Redirecting to ", hostValue, '.');
+  _QueueResponse(_client, redirectResponse, true);
+  _FlushSendBuffer(_client);
+}
+
+bool Server::_ReadBuffer(ClientSocket &_client, size_t &_read) {
+  const size_t offset = _client.recvBuffer.size();
+  int readTotal;
+
+  _read = 0;
+  BufferPool::Local().Acquire(_client.recvBuffer, offset + s_READ_CHUNK_SIZE);
+  _client.recvBuffer.resize(offset + s_READ_CHUNK_SIZE);
+
   if (_client.encrypted) {
-    int readTotal;
     try {
-      readTotal = SSL_read(_client.socket, _buffer.data(), _buffer.size());
+      ERR_clear_error();
+      readTotal = SSL_read(_client.socket, _client.recvBuffer.data() + offset, s_READ_CHUNK_SIZE);
     }
     catch (const std::exception&) {
-      GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: SSL_read threw an exception");
+      WEPP_LOG_WARNING('[', SSL_get_fd(_client.socket), "]: SSL_read threw an exception");
       readTotal = -1;
     }
 
-    if (readTotal <= 0)
-    {
-      _buffer.clear();
-      m_mutex.unlock();
+    if (readTotal <= 0) {
+      _client.recvBuffer.resize(offset);
+
+      // An incomplete TLS record is not an error
+      switch (SSL_get_error(_client.socket, readTotal)) {
+      case SSL_ERROR_WANT_READ:
+        return true;
+      case SSL_ERROR_WANT_WRITE:
+        _client.interest = EVENT_WRITE;
+        return true;
+      default:
+        return false;
+      }
+    }
+  } else {
+    readTotal = GNetworking::SocketRecv(SSL_get_fd(_client.socket), (char *)_client.recvBuffer.data() + offset, s_READ_CHUNK_SIZE, 0);
+
+    if (readTotal <= 0) {
+      _client.recvBuffer.resize(offset);
+      return readTotal < 0 && SocketWouldBlock();
+    }
+  }
+
+  _client.recvBuffer.resize(offset + readTotal);
+  _client.bytesReceived += readTotal;
+  CountMetric(COUNTER_BYTES_RECEIVED, readTotal);
+  _client.lastActivity = std::chrono::steady_clock::now();
+  _read = readTotal;
+
+  if (offset == 0) {
+    _client.requestStarted = _client.lastActivity;
+  }
+
+  return true;
+}
+
+void Server::_RejectRequest(ClientSocket &_client, const int _status) {
+  GParsing::HTTPResponse resp;
+
+  SetResponseStatus(resp, _status == 413 || _status == 431 || _status == 501 ? _status : 400);
+
+  // The rest of the stream cannot be framed, so the connection ends here
+  resp.headers.push_back({"Content-Length", {"0"}});
+  resp.headers.push_back({"Connection", {"close"}});
+  _client.recvBuffer.clear();
+  _client.parser.Reset();
+
+  _QueueResponse(_client, resp, true);
+  _FlushSendBuffer(_client);
+}
+
+void Server::_QueueResponse(ClientSocket &_client, GParsing::HTTPResponse &_resp, const bool _close, const std::string_view &_rawHeaders) {
+  WEPP_LOG_TRACE('[', SSL_get_fd(_client.socket), "]: Sending response");
+
+  const size_t headSize = ResponseHeadSize(_resp, _rawHeaders);
+
+  if (_resp.response_code >= 100 && _resp.response_code < 600) {
+    CountMetric((MetricCounter)(COUNTER_RESPONSES_1XX + _resp.response_code / 100 - 1));
+  }
+
+  // Interim responses are followed by the final one, so their bytes cannot wait behind the body segments.
+  // Small encrypted responses are copied behind the headers to go out as one TLS record.
+  const bool inlineBody = _resp.response_code < 200 || (_client.encrypted && headSize + _resp.message.size() <= s_TLS_RECORD_SIZE);
+  const size_t queued = _client.sendBuffer.size() + headSize + (inlineBody ? _resp.message.size() : 0);
+
+  BufferPool::Local().Acquire(_client.sendBuffer, queued);
+  AppendResponseHead(_resp, _client.sendBuffer, _rawHeaders);
+
+  if (inlineBody) {
+    _client.sendBuffer.insert(_client.sendBuffer.end(), _resp.message.begin(), _resp.message.end());
+  } else {
+    _client.body.AppendData(std::move(_resp.message));
+  }
+
+  _resp.message.clear();
+  _client.closeAfterSend = _client.closeAfterSend || _close;
+}
+
+bool Server::_AttachFileBody(ClientSocket &_client, GParsing::HTTPResponse &_resp, ResponseBuilder &_builder) {
+  std::shared_ptr<const std::vector<unsigned char>> shared;
+
+  // Written straight from the cache's buffer once the headers are flushed. Small encrypted bodies are copied
+  // instead, so _QueueResponse puts them in one TLS record with the headers.
+  if (_builder.TakeSharedBody(shared)) {
+    if (_client.encrypted && ResponseHeadSize(_resp, _builder.GetRawHeaders()) + shared->size() <= s_TLS_RECORD_SIZE) {
+      _resp.message.assign(shared->begin(), shared->end());
+    } else {
+      _client.body.Clear();
+      _client.body.AppendData(shared);
+    }
+
+    return true;
+  }
+
+  FileBody body;
+  uint64_t size;
+
+  // Only set through the builder, a handler's headers never select a file
+  if (!_builder.TakeFileBody(body)) {
+    return true;
+  }
+
+  // Cached descriptors are shared and only closed by their last owner
+  if (!FileDescriptorSize(body.file->Get(), size)) {
+    SetResponseStatus(_resp, 404);
+    _resp.message.clear();
+    SetResponseHeader(_resp, "Content-Length", "0");
+    return false;
+  }
+
+  // Headers are queued first by _QueueResponse, the body follows once they are flushed
+  _client.body.Reset(body.file);
+
+  _resp.message.clear();
+
+  if (body.parts.empty()) {
+    _client.body.AppendFileRange(0, size);
+  }
+
+  for (const FileBodyPart &part : body.parts) {
+    if (part.length == 0) {
+      _client.body.AppendData(part.data);
+      continue;
+    }
+
+    // Ranges were chosen against cached metadata, the file may have shrunk since
+    if (part.offset > size || part.length > size - part.offset) {
+      _client.body.Clear();
+
+      SetResponseStatus(_resp, 500);
+      _resp.message.clear();
+      SetResponseHeader(_resp, "Content-Length", "0");
       return false;
     }
 
-    // For possible SSL layer buffering
-    if (readTotal != _buffer.size())
-    {
-      while (SSL_pending(_client.socket) && !GNetworking::SocketPoll(SSL_get_fd(_client.socket), GNetworkingPOLLHUP))
-      {
-        int readAmount = SSL_read(_client.socket, _buffer.data() + readTotal, _buffer.size() - readTotal);
+    _client.body.AppendFileRange(part.offset, part.length);
+  }
 
-        if (readAmount <= 0)
-        {
-          break;
-        }
+  SetResponseHeader(_resp, "Content-Length", std::to_string(_client.body.Size()));
+  return true;
+}
+
+bool Server::_FlushSendBuffer(ClientSocket &_client) {
+  uint64_t bodyBytesSent = 0;
+  size_t written;
 
-        readTotal += readAmount;
+  while (true) {
+    // Queued headers and the inline body parts behind them share one gathered write
+    while (_client.sendOffset < _client.sendBuffer.size() || _client.body.FrontIsData()) {
+      if (!_WriteGathered(_client, written)) {
+        _client.state = CLIENT_CLOSING;
+        return false;
       }
+
+      // Would block, interest is already set
+      if (written == 0) {
+        return true;
+      }
+
+      _ConsumeWritten(_client, written, bodyBytesSent);
     }
-  } else {
-    int readTotal = GNetworking::SocketRecv(SSL_get_fd(_client.socket), (char *)_buffer.data(), _buffer.size(), 0);
 
-    if (readTotal <= 0)
-    {
-      m_mutex.unlock();
+    _client.sendBuffer.clear();
+    _client.sendOffset = 0;
+
+    if (_client.body.Empty()) {
+      // Closes the body's file
+      _client.body.Clear();
+      break;
+    }
+
+    // Let other connections on this worker make progress during large bodies
+    if (bodyBytesSent >= s_MAX_BODY_BYTES_PER_DISPATCH) {
+      _client.interest = EVENT_WRITE;
+      return true;
+    }
+
+    if (!_SendBodySegment(_client, bodyBytesSent)) {
+      _client.state = CLIENT_CLOSING;
       return false;
     }
+
+    if (_client.interest == EVENT_WRITE) {
+      return true;
+    }
+  }
+
+  _client.lastActivity = std::chrono::steady_clock::now();
+
+  // Only responses to parsed requests are timed, not redirects or rejections
+  if (_client.sendStarted != std::chrono::steady_clock::time_point()) {
+    RecordLatency(PHASE_SEND, _client.lastActivity - _client.sendStarted);
+    _client.sendStarted = std::chrono::steady_clock::time_point();
+  }
+
+  if (_client.closeAfterSend) {
+    _client.state = CLIENT_CLOSING;
   }
-  m_mutex.unlock();
+
   return true;
 }
 
-bool Server::_SendBuffer(const ClientSocket&_client, const std::vector<unsigned char> &_buffer, bool _close) {
-  GLog::Log(GLog::LOG_TRACE, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: Sending response");
-  if (GNetworking::SocketPoll(SSL_get_fd(_client.socket), GNetworkingPOLLHUP)) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: Failed to send on socket");
-    GNetworking::SocketShutdown(SSL_get_fd(_client.socket), GNetworkingSHUTDOWNRDWR);
-    return false;
+bool Server::_WriteGathered(ClientSocket &_client, size_t &_written) {
+  const unsigned char *data[s_MAX_WRITE_VECTORS];
+  size_t lengths[s_MAX_WRITE_VECTORS];
+  size_t count = 0;
+
+  _written = 0;
+
+  if (_client.sendOffset < _client.sendBuffer.size()) {
+    data[count] = _client.sendBuffer.data() + _client.sendOffset;
+    lengths[count++] = _client.sendBuffer.size() - _client.sendOffset;
+  }
+
+  for (size_t i = 0; i < _client.body.SegmentCount() && count < s_MAX_WRITE_VECTORS; i++) {
+    const BodySegment &segment = _client.body.Segment(i);
+    if (segment.fileLength > 0) {
+      break;
+    }
+
+    data[count] = segment.Bytes() + segment.dataOffset;
+    lengths[count++] = segment.ByteCount() - segment.dataOffset;
   }
 
-  m_mutex.lock();
   if (_client.encrypted) {
+    // OpenSSL has no gathered write. Small responses were already coalesced into one record when queued.
+    const int length = lengths[0] > INT_MAX ? INT_MAX : (int)lengths[0];
+    int written;
+
     try {
-      if (SSL_write(_client.socket, _buffer.data(), _buffer.size()) <= 0)
-      {
-        m_mutex.unlock();
-        return false;
-      }     
+      ERR_clear_error();
+      written = SSL_write(_client.socket, data[0], length);
     }
     catch (const std::exception&) {
-      GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(SSL_get_fd(_client.socket)) + "]: SSL_write threw an exception");
-      m_mutex.unlock();
+      WEPP_LOG_WARNING('[', SSL_get_fd(_client.socket), "]: SSL_write threw an exception");
       return false;
     }
-  } else {
-    if (GNetworking::SocketSend(SSL_get_fd(_client.socket), (char*)_buffer.data(), _buffer.size(), 0) <= 0)
-    {
-      m_mutex.unlock();
-      return false;
+
+    if (written <= 0) {
+      switch (SSL_get_error(_client.socket, written)) {
+      case SSL_ERROR_WANT_WRITE:
+        _client.interest = EVENT_WRITE;
+        return true;
+      case SSL_ERROR_WANT_READ:
+        _client.interest = EVENT_READ;
+        return true;
+      default:
+        return false;
+      }
     }
+
+    _written = written;
+    return true;
   }
 
-  if (_close) {
-    GNetworking::SocketShutdown(SSL_get_fd(_client.socket), GNetworkingSHUTDOWNRDWR);
+#ifdef _WIN32
+  const int length = lengths[0] > INT_MAX ? INT_MAX : (int)lengths[0];
+  const int64_t written = GNetworking::SocketSend(SSL_get_fd(_client.socket), (const char *)data[0], length, 0);
+#else
+  iovec vectors[s_MAX_WRITE_VECTORS];
+  for (size_t i = 0; i < count; i++) {
+    vectors[i].iov_base = (void *)data[i];
+    vectors[i].iov_len = lengths[i];
   }
-  m_mutex.unlock();
-  return true;
-}
 
-void Server::_HandleOnThread(const ClientSocket&_client, WEPP_HANDLER_FUNC _handler, WEPP_POST_HANDLER_SUCCESS_FUNC _postHandler) {
-  bool closeConnection;
-  GParsing::HTTPRequest req;
-  GParsing::HTTPResponse resp;
-  GParsing::HTTPResponse intermediateResp;
-  std::vector<unsigned char> recvBuffer;
-  GNetworking::GNetworkingSocket clientSocket = SSL_get_fd(_client.socket);
+  const int64_t written = writev(SSL_get_fd(_client.socket), vectors, (int)count);
+#endif // _WIN32
 
-  size_t recvSize;
+  if (written < 0 && SocketWouldBlock()) {
+    _client.interest = EVENT_WRITE;
+    return true;
+  }
 
-  if (GNetworking::SocketPoll(clientSocket, GNetworkingPOLLHUP)) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(clientSocket) + "]: Socket closed before being handled");
-    m_mutex.lock();
-    GNetworking::SocketShutdown(clientSocket, GNetworkingSHUTDOWNRDWR);
-    m_mutex.unlock();
-    return;
+  if (written <= 0) {
+    return false;
   }
 
-  if (!GNetworking::SocketPoll(clientSocket, GNetworkingPOLLIN)) {
+  _written = written;
+  return true;
+}
+
+void Server::_ConsumeWritten(ClientSocket &_client, size_t _written, uint64_t &_bodySent) {
+  // Any progress postpones the write deadline
+  _client.lastActivity = std::chrono::steady_clock::now();
+  _client.bytesSent += _written;
+  CountMetric(COUNTER_BYTES_SENT, _written);
+
+  const size_t buffered = _client.sendBuffer.size() - _client.sendOffset;
+  if (_written <= buffered) {
+    _client.sendOffset += _written;
     return;
   }
 
-  recvSize = _FindReadSize(_client);
+  _client.sendOffset = _client.sendBuffer.size();
+  _written -= buffered;
+  _bodySent += _written;
 
-  if (recvSize <= 0) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(clientSocket) + "]: Unable to read on socket");
-    m_mutex.lock();
-    GNetworking::SocketShutdown(clientSocket, GNetworkingSHUTDOWNRDWR);
-    m_mutex.unlock();
-    return;
+  while (_written > 0) {
+    BodySegment &segment = _client.body.Front();
+    const size_t remaining = segment.ByteCount() - segment.dataOffset;
+
+    if (_written < remaining) {
+      segment.dataOffset += _written;
+      return;
+    }
+
+    _written -= remaining;
+    _client.body.PopFront();
   }
+}
 
-  recvBuffer.resize(recvSize);
-  if (!_ReadBuffer(_client, recvBuffer))
-  {
-    m_mutex.lock();
-    GNetworking::SocketShutdown(clientSocket, GNetworkingSHUTDOWNRDWR);
-    m_mutex.unlock();
-    return;
+bool Server::_SendBodySegment(ClientSocket &_client, uint64_t &_sent) {
+  const GNetworking::GNetworkingSocket clientSocket = SSL_get_fd(_client.socket);
+  BodySegment &segment = _client.body.Front();
+  int64_t sent;
+
+  _client.interest = EVENT_READ;
+
+#ifdef __linux__
+  if (!_client.encrypted) {
+    off_t offset = segment.fileOffset;
+    sent = sendfile(clientSocket, _client.body.FileDescriptor(), &offset, segment.fileLength);
+
+    if (sent < 0 && SocketWouldBlock()) {
+      _client.interest = EVENT_WRITE;
+      return true;
+    }
+
+    // A file that shrank underneath us can never be completed
+    if (sent <= 0) {
+      return false;
+    }
+
+    _AdvanceBodySegment(_client, sent);
+    _client.bytesSent += sent;
+    CountMetric(COUNTER_BYTES_SENT, sent);
+    _sent += sent;
+    return true;
   }
+#endif // __linux__
+
+#ifdef WEPP_SERVER_KTLS
+  if (_client.encrypted && BIO_get_ktls_send(SSL_get_wbio(_client.socket))) {
+    ERR_clear_error();
+    sent = SSL_sendfile(_client.socket, _client.body.FileDescriptor(), segment.fileOffset, segment.fileLength, 0);
+
+    if (sent <= 0) {
+      const int error = SSL_get_error(_client.socket, sent);
+      if (error == SSL_ERROR_WANT_WRITE) {
+        _client.interest = EVENT_WRITE;
+        return true;
+      }
 
-  recvBuffer.push_back('\0');
-  GLog::Log(GLog::LOG_TRACE, (char *)recvBuffer.data());
-  try {
-    req.ParseRequest(recvBuffer);
-  } catch (const std::exception &e) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(clientSocket) + "]: Failed to Parse HTTP from buffer. Error: " + e.what());
-    m_mutex.lock();
-    GNetworking::SocketShutdown(clientSocket, GNetworkingSHUTDOWNRDWR);
-    m_mutex.unlock();
-    return;
+      return false;
+    }
+
+    _AdvanceBodySegment(_client, sent);
+    _client.bytesSent += sent;
+    CountMetric(COUNTER_BYTES_SENT, sent);
+    _sent += sent;
+    return true;
   }
+#endif // WEPP_SERVER_KTLS
 
-  GLog::Log(GLog::LOG_TRACE, '[' + std::to_string(clientSocket) + "]: Sending request to handler");
+  // Fallback: one bounded chunk through the regular send buffer, so memory stays constant per connection
+  const size_t chunkSize = segment.fileLength < s_FILE_CHUNK_SIZE ? segment.fileLength : s_FILE_CHUNK_SIZE;
+  _client.sendBuffer.resize(chunkSize);
+  sent = ReadFileDescriptor(_client.body.FileDescriptor(), segment.fileOffset, _client.sendBuffer.data(), chunkSize);
 
-  if (_handler(req, resp, closeConnection)) {
-    GLog::Log(GLog::LOG_TRACE, '[' + std::to_string(clientSocket) + "]: Request successful, sending to post handler");
-    if (_postHandler(req, intermediateResp)) {
-      GLog::Log(GLog::LOG_TRACE, '[' + std::to_string(clientSocket) + "]: Post handler successful, sending to client");
-      _SendBuffer(_client, intermediateResp.CreateResponse(), false);
-    }
+  if (sent <= 0) {
+    _client.sendBuffer.clear();
+    return false;
   }
 
-  if (!_SendBuffer(_client, resp.CreateResponse(), closeConnection)) {
-    GLog::Log(GLog::LOG_WARNING, '[' + std::to_string(clientSocket) + "]: Response send failed");    
-    GNetworking::SocketShutdown(clientSocket, GNetworkingSHUTDOWNRDWR);
+  _client.sendBuffer.resize(sent);
+  _AdvanceBodySegment(_client, sent);
+  _sent += sent;
+  return true;
+}
+
+void Server::_AdvanceBodySegment(ClientSocket &_client, const uint64_t _sent) {
+  BodySegment &segment = _client.body.Front();
+  segment.fileOffset += _sent;
+  segment.fileLength -= _sent;
+  _client.lastActivity = std::chrono::steady_clock::now();
+
+  if (segment.fileLength == 0) {
+    _client.body.PopFront();
   }
 }
 
-GNetworking::GNetworkingSocket &Server::GetServerSocket() {
-  return m_serverSocket;
+GNetworking::GNetworkingSocket &Server::GetServerSocket(const size_t _loop) {
+  return m_loops.at(_loop)->listener;
 }
-std::vector<ClientSocket> &Server::GetClientSockets() {
-  return m_clientSockets;
+
+ConnectionTable &Server::GetConnections(const size_t _loop) {
+  return m_loops.at(_loop)->connections;
+}
+
+void Server::SetEventLoopCount(const size_t _loops, const bool _pinThreads) {
+  m_loopCount = _loops == 0 ? 1 : _loops;
+  m_pinLoopThreads = _pinThreads;
+}
+
+const size_t &Server::GetEventLoopCount() {
+  return m_loopCount;
+}
+
+void Server::SetKeepAliveTimeout(const std::chrono::milliseconds &_timeout) {
+  m_keepAliveTimeout = _timeout;
+}
+
+const std::chrono::milliseconds &Server::GetKeepAliveTimeout() {
+  return m_keepAliveTimeout;
+}
+
+void Server::SetHandshakeTimeout(const std::chrono::milliseconds &_timeout) {
+  m_handshakeTimeout = _timeout;
+}
+
+const std::chrono::milliseconds &Server::GetHandshakeTimeout() {
+  return m_handshakeTimeout;
+}
+
+void Server::SetRequestHeaderTimeout(const std::chrono::milliseconds &_timeout) {
+  m_requestHeaderTimeout = _timeout;
+}
+
+const std::chrono::milliseconds &Server::GetRequestHeaderTimeout() {
+  return m_requestHeaderTimeout;
+}
+
+void Server::SetRequestBodyTimeout(const std::chrono::milliseconds &_timeout) {
+  m_requestBodyTimeout = _timeout;
+}
+
+const std::chrono::milliseconds &Server::GetRequestBodyTimeout() {
+  return m_requestBodyTimeout;
+}
+
+void Server::SetWriteTimeout(const std::chrono::milliseconds &_timeout) {
+  m_writeTimeout = _timeout;
+}
+
+const std::chrono::milliseconds &Server::GetWriteTimeout() {
+  return m_writeTimeout;
+}
+
+void Server::SetMaxConnections(const size_t _maxConnections) {
+  m_admission.SetMaxConnections(_maxConnections);
+}
+
+const size_t &Server::GetMaxConnections() {
+  return m_admission.GetMaxConnections();
+}
+
+void Server::SetMaxConnectionsPerAddress(const size_t _maxConnections) {
+  m_admission.SetMaxConnectionsPerAddress(_maxConnections);
+}
+
+const size_t &Server::GetMaxConnectionsPerAddress() {
+  return m_admission.GetMaxConnectionsPerAddress();
+}
+
+void Server::SetMaxKeepAliveRequests(const size_t _maxRequests) {
+  m_maxKeepAliveRequests = _maxRequests;
+}
+
+const size_t &Server::GetMaxKeepAliveRequests() {
+  return m_maxKeepAliveRequests;
+}
+
+void Server::SetMaxRequestHeaderSize(const size_t _maxSize) {
+  m_maxRequestHeaderSize = _maxSize;
+}
+
+const size_t &Server::GetMaxRequestHeaderSize() {
+  return m_maxRequestHeaderSize;
+}
+
+void Server::SetMaxRequestBodySize(const uint64_t _maxSize) {
+  m_maxRequestBodySize = _maxSize;
+}
+
+const uint64_t &Server::GetMaxRequestBodySize() {
+  return m_maxRequestBodySize;
+}
+
+TLSSessionStats Server::GetTLSSessionStats() {
+  return m_tlsSessions.GetStats();
+}
+
+void Server::SetMetricsPath(const std::string &_path) {
+  m_metricsPath = _path;
+}
+
+const std::string &Server::GetMetricsPath() {
+  return m_metricsPath;
 }
 } // namespace Wepp
@@ -0,0 +1,114 @@
+#include "Wepp/Server/StreamingBody.hpp"
+#include <utility>
+
+namespace Wepp {
+StreamingBody::StreamingBody() {}
+
+StreamingBody::StreamingBody(StreamingBody &&_body) : StreamingBody() {
+  *this = std::move(_body);
+}
+
+StreamingBody &StreamingBody::operator=(StreamingBody &&_body) {
+  if (this != &_body) {
+    Clear();
+    m_file = std::move(_body.m_file);
+    m_segments = std::move(_body.m_segments);
+
+    _body.m_file.reset();
+    _body.m_segments.clear();
+  }
+
+  return *this;
+}
+
+StreamingBody::~StreamingBody() {
+  Clear();
+}
+
+void StreamingBody::Reset(const int _fileDescriptor) {
+  Clear();
+
+  if (_fileDescriptor >= 0) {
+    m_file = std::make_shared<const FileHandle>(_fileDescriptor);
+  }
+}
+
+void StreamingBody::Reset(const std::shared_ptr<const FileHandle> &_file) {
+  Clear();
+  m_file = _file;
+}
+
+void StreamingBody::AppendFileRange(const uint64_t _offset, const uint64_t _length) {
+  if (_length == 0) {
+    return;
+  }
+
+  m_segments.push_back({{}, 0, _offset, _length, nullptr});
+}
+
+void StreamingBody::AppendData(std::vector<unsigned char> &&_data) {
+  if (_data.empty()) {
+    return;
+  }
+
+  m_segments.push_back({std::move(_data), 0, 0, 0, nullptr});
+}
+
+void StreamingBody::AppendData(const std::string &_data) {
+  if (_data.empty()) {
+    return;
+  }
+
+  m_segments.push_back({std::vector<unsigned char>(_data.begin(), _data.end()), 0, 0, 0, nullptr});
+}
+
+void StreamingBody::AppendData(const std::shared_ptr<const std::vector<unsigned char>> &_data) {
+  if (!_data || _data->empty()) {
+    return;
+  }
+
+  m_segments.push_back({{}, 0, 0, 0, _data});
+}
+
+bool StreamingBody::Empty() const {
+  return m_segments.empty();
+}
+
+uint64_t StreamingBody::Size() const {
+  uint64_t output = 0;
+  for (const BodySegment &segment : m_segments) {
+    output += segment.fileLength > 0 ? segment.fileLength : segment.ByteCount() - segment.dataOffset;
+  }
+
+  return output;
+}
+
+int StreamingBody::FileDescriptor() const {
+  return m_file ? m_file->Get() : -1;
+}
+
+BodySegment &StreamingBody::Front() {
+  return m_segments.front();
+}
+
+bool StreamingBody::FrontIsData() const {
+  return !m_segments.empty() && m_segments.front().fileLength == 0;
+}
+
+size_t StreamingBody::SegmentCount() const {
+  return m_segments.size();
+}
+
+BodySegment &StreamingBody::Segment(const size_t _index) {
+  return m_segments[_index];
+}
+
+void StreamingBody::PopFront() {
+  m_segments.pop_front();
+}
+
+void StreamingBody::Clear() {
+  m_segments.clear();
+  m_file.reset();
+}
+} // namespace Wepp
@@ -0,0 +1,196 @@
+#include "Wepp/Server/TLSSessions.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include <cstring>
+#include <mutex>
+#include <openssl/rand.h>
+#include <stdexcept>
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#include <openssl/params.h>
+#endif // OPENSSL_VERSION_NUMBER
+
+namespace Wepp {
+static constexpr long s_SESSION_CACHE_SIZE = 20480;
+static constexpr long s_SESSION_TIMEOUT_SECONDS = 300;
+static constexpr std::chrono::hours s_TICKET_KEY_LIFETIME(1);
+
+static const unsigned char s_SESSION_ID_CONTEXT[] = "Wepp";
+
+TLSSessionCache::TLSSessionCache()
+    : m_sslCTX(nullptr), m_fullHandshakes(0), m_resumedHandshakes(0), m_ticketsIssued(0), m_ticketsAccepted(0),
+      m_ticketsRenewed(0), m_ticketsRejected(0) {
+  m_currentKey.valid = false;
+  m_previousKey.valid = false;
+}
+
+TLSSessionCache::~TLSSessionCache() {
+  OPENSSL_cleanse(&m_currentKey, sizeof(m_currentKey));
+  OPENSSL_cleanse(&m_previousKey, sizeof(m_previousKey));
+}
+
+void TLSSessionCache::Configure(SSL_CTX *const _sslCTX) {
+  m_sslCTX = _sslCTX;
+
+  if (SSL_CTX_set_session_id_context(m_sslCTX, s_SESSION_ID_CONTEXT, sizeof(s_SESSION_ID_CONTEXT) - 1) != 1) {
+    throw std::runtime_error("Cannot set SSL session ID context");
+  }
+
+  SSL_CTX_set_session_cache_mode(m_sslCTX, SSL_SESS_CACHE_SERVER);
+  SSL_CTX_sess_set_cache_size(m_sslCTX, s_SESSION_CACHE_SIZE);
+  SSL_CTX_set_timeout(m_sslCTX, s_SESSION_TIMEOUT_SECONDS);
+
+  _RotateKeys(false);
+
+  SSL_CTX_set_app_data(m_sslCTX, this);
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (SSL_CTX_set_tlsext_ticket_key_evp_cb(m_sslCTX, &TLSSessionCache::_TicketKeyCallback) != 1) {
+#else
+  if (SSL_CTX_set_tlsext_ticket_key_cb(m_sslCTX, &TLSSessionCache::_TicketKeyCallback) != 1) {
+#endif // OPENSSL_VERSION_NUMBER
+    throw std::runtime_error("Cannot set SSL session ticket key callback");
+  }
+}
+
+void TLSSessionCache::RecordHandshake(const SSL *const _ssl) {
+  if (SSL_session_reused(_ssl)) {
+    m_resumedHandshakes++;
+  } else {
+    m_fullHandshakes++;
+  }
+}
+
+TLSSessionStats TLSSessionCache::GetStats() {
+  TLSSessionStats output;
+
+  output.fullHandshakes = m_fullHandshakes;
+  output.resumedHandshakes = m_resumedHandshakes;
+
+  output.cacheHits = m_sslCTX ? SSL_CTX_sess_hits(m_sslCTX) : 0;
+  output.cacheMisses = m_sslCTX ? SSL_CTX_sess_misses(m_sslCTX) : 0;
+  output.cacheTimeouts = m_sslCTX ? SSL_CTX_sess_timeouts(m_sslCTX) : 0;
+  output.cacheSize = m_sslCTX ? SSL_CTX_sess_number(m_sslCTX) : 0;
+
+  output.ticketsIssued = m_ticketsIssued;
+  output.ticketsAccepted = m_ticketsAccepted;
+  output.ticketsRenewed = m_ticketsRenewed;
+  output.ticketsRejected = m_ticketsRejected;
+
+  return output;
+}
+
+void TLSSessionCache::_RotateKeys(const bool _onlyIfExpired) {
+  TicketKey key;
+
+  if (RAND_bytes(key.name, sizeof(key.name)) != 1 || RAND_bytes(key.aesKey, sizeof(key.aesKey)) != 1 ||
+      RAND_bytes(key.hmacKey, sizeof(key.hmacKey)) != 1) {
+    throw std::runtime_error("Cannot generate SSL session ticket key");
+  }
+
+  key.created = std::chrono::steady_clock::now();
+  key.valid = true;
+
+  std::unique_lock<std::shared_mutex> lock(m_keyMutex);
+
+  // Another thread may have rotated while this one was generating
+  if (_onlyIfExpired && m_currentKey.valid && key.created - m_currentKey.created < s_TICKET_KEY_LIFETIME) {
+    OPENSSL_cleanse(&key, sizeof(key));
+    return;
+  }
+
+  m_previousKey = m_currentKey;
+  m_currentKey = key;
+  OPENSSL_cleanse(&key, sizeof(key));
+
+  WEPP_LOG_DEBUG("Rotated SSL session ticket keys");
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+int TLSSessionCache::_TicketKeyCallback(SSL *_ssl, unsigned char _keyName[16], unsigned char *_iv, EVP_CIPHER_CTX *_cipherCTX, EVP_MAC_CTX *_macCTX, int _encrypt) {
+#else
+int TLSSessionCache::_TicketKeyCallback(SSL *_ssl, unsigned char _keyName[16], unsigned char *_iv, EVP_CIPHER_CTX *_cipherCTX, HMAC_CTX *_macCTX, int _encrypt) {
+#endif // OPENSSL_VERSION_NUMBER
+  TLSSessionCache *cache = (TLSSessionCache *)SSL_CTX_get_app_data(SSL_get_SSL_CTX(_ssl));
+  const TicketKey *key = nullptr;
+  bool expired;
+  int output = 1;
+
+  if (!cache) {
+    return -1;
+  }
+
+  if (_encrypt) {
+    {
+      std::shared_lock<std::shared_mutex> lock(cache->m_keyMutex);
+      expired = std::chrono::steady_clock::now() - cache->m_currentKey.created >= s_TICKET_KEY_LIFETIME;
+    }
+
+    if (expired) {
+      try {
+        cache->_RotateKeys(true);
+      } catch (const std::exception &e) {
+        WEPP_LOG_WARNING(e.what());
+      }
+    }
+  }
+
+  std::shared_lock<std::shared_mutex> lock(cache->m_keyMutex);
+
+  if (_encrypt) {
+    key = &cache->m_currentKey;
+
+    if (RAND_bytes(_iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) != 1) {
+      return -1;
+    }
+
+    std::memcpy(_keyName, key->name, sizeof(key->name));
+  } else {
+    if (std::memcmp(_keyName, cache->m_currentKey.name, sizeof(cache->m_currentKey.name)) == 0) {
+      key = &cache->m_currentKey;
+    } else if (cache->m_previousKey.valid && std::memcmp(_keyName, cache->m_previousKey.name, sizeof(cache->m_previousKey.name)) == 0) {
+      // Still valid, but ask OpenSSL to issue a ticket under the current key
+      key = &cache->m_previousKey;
+      output = 2;
+    } else {
+      cache->m_ticketsRejected++;
+      return 0;
+    }
+  }
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  OSSL_PARAM params[] = {
+      OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, (void *)key->hmacKey, sizeof(key->hmacKey)),
+      OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, (char *)"SHA256", 0),
+      OSSL_PARAM_construct_end(),
+  };
+
+  if (EVP_MAC_CTX_set_params(_macCTX, params) != 1) {
+    return -1;
+  }
+#else
+  if (HMAC_Init_ex(_macCTX, key->hmacKey, sizeof(key->hmacKey), EVP_sha256(), nullptr) != 1) {
+    return -1;
+  }
+#endif // OPENSSL_VERSION_NUMBER
+
+  if (_encrypt) {
+    if (EVP_EncryptInit_ex(_cipherCTX, EVP_aes_256_cbc(), nullptr, key->aesKey, _iv) != 1) {
+      return -1;
+    }
+
+    cache->m_ticketsIssued++;
+  } else {
+    if (EVP_DecryptInit_ex(_cipherCTX, EVP_aes_256_cbc(), nullptr, key->aesKey, _iv) != 1) {
+      return -1;
+    }
+
+    if (output == 2) {
+      cache->m_ticketsRenewed++;
+    } else {
+      cache->m_ticketsAccepted++;
+    }
+  }
+
+  return output;
+}
+} // namespace Wepp
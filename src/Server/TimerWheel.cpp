@@ -0,0 +1,85 @@
+#include "Wepp/Server/TimerWheel.hpp"
+#include <utility>
+
+namespace Wepp {
+TimerWheel::TimerWheel(const std::chrono::steady_clock::duration &_tick) : m_TICK(_tick), m_START(std::chrono::steady_clock::now()), m_current(0), m_size(0) {}
+
+void TimerWheel::Schedule(const uint64_t _id, const std::chrono::steady_clock::time_point &_deadline) {
+  // Rounded up so a timer never fires before its deadline
+  const auto elapsed = _deadline > m_START ? _deadline - m_START : std::chrono::steady_clock::duration::zero();
+  uint64_t expiry = (uint64_t)((elapsed + m_TICK - std::chrono::steady_clock::duration(1)) / m_TICK);
+
+  // The current tick has already fired
+  if (expiry <= m_current) {
+    expiry = m_current + 1;
+  }
+
+  _Insert({_id, expiry});
+  m_size++;
+}
+
+void TimerWheel::Advance(const std::chrono::steady_clock::time_point &_now, std::vector<uint64_t> &_expired) {
+  if (_now <= m_START) {
+    return;
+  }
+
+  const uint64_t target = (uint64_t)((_now - m_START) / m_TICK);
+
+  while (m_current < target && m_size > 0) {
+    m_current++;
+
+    // Whenever a level wraps, the next slot of the level above is spread over the levels below
+    for (size_t level = 1; level < s_LEVEL_COUNT; level++) {
+      if ((m_current & (((uint64_t)1 << (s_SLOT_BITS * level)) - 1)) != 0) {
+        break;
+      }
+
+      std::vector<Timer> cascading;
+      cascading.swap(m_slots[level][(m_current >> (s_SLOT_BITS * level)) & (s_SLOT_COUNT - 1)]);
+
+      for (const Timer &timer : cascading) {
+        _Insert(timer);
+      }
+    }
+
+    std::vector<Timer> &slot = m_slots[0][m_current & (s_SLOT_COUNT - 1)];
+    for (const Timer &timer : slot) {
+      _expired.push_back(timer.id);
+    }
+
+    m_size -= slot.size();
+    slot.clear();
+  }
+
+  // Nothing is pending, so the empty ticks in between can be skipped
+  if (m_current < target) {
+    m_current = target;
+  }
+}
+
+size_t TimerWheel::Size() const {
+  return m_size;
+}
+
+void TimerWheel::_Insert(const Timer &_timer) {
+  Timer timer = _timer;
+
+  // Cascaded timers may be due on the current tick, which fires right after the cascade
+  if (timer.expiry < m_current) {
+    timer.expiry = m_current;
+  }
+
+  if (timer.expiry - m_current > s_MAX_TICKS) {
+    timer.expiry = m_current + s_MAX_TICKS;
+  }
+
+  const uint64_t delta = timer.expiry - m_current;
+  size_t level = 0;
+
+  while (level + 1 < s_LEVEL_COUNT && delta >= ((uint64_t)1 << (s_SLOT_BITS * (level + 1)))) {
+    level++;
+  }
+
+  m_slots[level][(timer.expiry >> (s_SLOT_BITS * level)) & (s_SLOT_COUNT - 1)].push_back(timer);
+}
+} // namespace Wepp
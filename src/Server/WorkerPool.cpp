@@ -0,0 +1,85 @@
+#include "Wepp/Server/WorkerPool.hpp"
+
+namespace Wepp {
+// Pops attempted before a worker goes to sleep
+static constexpr size_t s_SPIN_COUNT = 64;
+
+WorkerPool::WorkerPool(const size_t _threadCount, const size_t _queueCapacity)
+    : m_THREAD_COUNT(_threadCount == 0 ? 1 : _threadCount), m_queue(_queueCapacity), m_stop(false), m_pending(0), m_sleeping(0) {}
+
+WorkerPool::~WorkerPool() {
+  Stop();
+}
+
+void WorkerPool::Start(const WEPP_WORKER_FUNC &_workerFunc) {
+  m_workerFunc = _workerFunc;
+  m_stop = false;
+
+  m_threads.reserve(m_THREAD_COUNT);
+  for (size_t i = 0; i < m_THREAD_COUNT; i++) {
+    m_threads.emplace_back(&WorkerPool::_WorkerLoop, this);
+  }
+}
+
+void WorkerPool::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_stop = true;
+  }
+  m_sleepCondition.notify_all();
+
+  for (auto &thread : m_threads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+  m_threads.clear();
+}
+
+bool WorkerPool::Submit(ClientSocket *const _client) {
+  // Counted before the push so a racing pop never sees the counter underflow
+  m_pending.fetch_add(1);
+
+  if (!m_queue.TryPush(_client)) {
+    m_pending.fetch_sub(1);
+    return false;
+  }
+
+  if (m_sleeping.load() > 0) {
+    std::lock_guard<std::mutex> lock(m_sleepMutex);
+    m_sleepCondition.notify_one();
+  }
+
+  return true;
+}
+
+const size_t &WorkerPool::GetThreadCount() const {
+  return m_THREAD_COUNT;
+}
+
+void WorkerPool::_WorkerLoop() {
+  ClientSocket *client = nullptr;
+  size_t spins = 0;
+
+  while (!m_stop) {
+    if (m_queue.TryPop(client)) {
+      m_pending.fetch_sub(1);
+      spins = 0;
+      m_workerFunc(*client);
+      continue;
+    }
+
+    if (++spins < s_SPIN_COUNT) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_sleeping.fetch_add(1);
+    m_sleepCondition.wait(lock, [this]() { return m_stop || m_pending.load() > 0; });
+    m_sleeping.fetch_sub(1);
+    spins = 0;
+  }
+}
+} // namespace Wepp
@@ -0,0 +1,67 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/ByteScan.hpp"
+#include <random>
+#include <string>
+
+static size_t ReferenceHeaderEnd(const std::string &_data, const size_t _start) {
+  const size_t output = _data.find("\r\n\r\n", _start);
+  return output == std::string::npos ? _data.size() : output;
+}
+
+static size_t ReferenceLineEnd(const std::string &_data, const size_t _start, size_t &_colon) {
+  size_t output = _data.find('\n', _start);
+  output = output == std::string::npos ? _data.size() : output;
+
+  _colon = _data.find(':', _start);
+  _colon = _colon == std::string::npos || _colon > output ? _data.size() : _colon;
+  return output;
+}
+
+// Every start offset of inputs long enough to cross several vectors, so matches land on every lane and
+// straddle every block boundary. Mostly the searched bytes, to make matches and near misses frequent.
+static void TestAgainstReference() {
+  static const char ALPHABET[] = "\r\n:a ";
+  std::mt19937 generator(12345);
+
+  for (size_t size = 0; size < 200; size++) {
+    for (int round = 0; round < 8; round++) {
+      std::string data(size, 'a');
+
+      for (char &c : data) {
+        c = ALPHABET[generator() % (sizeof(ALPHABET) - 1)];
+      }
+
+      const unsigned char *bytes = (const unsigned char *)data.data();
+
+      for (size_t start = 0; start <= size; start++) {
+        size_t colon;
+        size_t expectedColon;
+
+        WEPP_CHECK(Wepp::FindHeaderEnd(bytes, size, start) == ReferenceHeaderEnd(data, start));
+        WEPP_CHECK(Wepp::FindLineEnd(bytes, size, start, colon) == ReferenceLineEnd(data, start, expectedColon));
+        WEPP_CHECK(colon == expectedColon);
+      }
+    }
+  }
+}
+
+static void TestHeaderLine() {
+  const std::string line = "X-Very-Long-Header-Name-That-Spans-Vectors: value: with colons\r\nNext: 1\r\n";
+  size_t colon;
+
+  const size_t end = Wepp::FindLineEnd((const unsigned char *)line.data(), line.size(), 0, colon);
+  WEPP_CHECK(end == line.find('\n'));
+  WEPP_CHECK(colon == line.find(':'));
+
+  // A colon on a later line is not reported for a line without one
+  const std::string bare = "no separator here at all, not in the first vector either\r\nName: value\r\n";
+  Wepp::FindLineEnd((const unsigned char *)bare.data(), bare.size(), 0, colon);
+  WEPP_CHECK(colon == bare.size());
+}
+
+int main() {
+  TestAgainstReference();
+  TestHeaderLine();
+
+  return WeppTest::Result("ByteScanTest");
+}
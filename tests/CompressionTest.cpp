@@ -0,0 +1,176 @@
+#include "TestCommon.hpp"
+#include "Wepp/FileHandling/Compression.hpp"
+#include "Wepp/FileHandling/FileCache.hpp"
+#include "Wepp/Server/HandlerFunctions.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static const Wepp::ContentEncoding s_ENCODINGS[] = {Wepp::ENCODING_GZIP, Wepp::ENCODING_BROTLI};
+
+// Repetitive like real markup and scripts, so every encoder shrinks it
+static std::string Script() {
+  std::string output;
+  for (int i = 0; i < 400; i++) {
+    output += "function handler" + std::to_string(i) + "(event) { return event.target.value; }\n";
+  }
+
+  return output;
+}
+
+static void TestCompress() {
+  const std::string script = Script();
+  const std::vector<unsigned char> input(script.begin(), script.end());
+
+  for (const Wepp::ContentEncoding encoding : s_ENCODINGS) {
+    if (!Wepp::CompressionAvailable(encoding)) {
+      std::printf("%s not built in, skipped\n", Wepp::ContentEncodingName(encoding));
+      continue;
+    }
+
+    std::vector<unsigned char> output;
+    WEPP_CHECK(Wepp::Compress(encoding, input, output));
+    WEPP_CHECK(!output.empty() && output.size() < input.size());
+    std::printf("%s: %zu -> %zu bytes\n", Wepp::ContentEncodingName(encoding), input.size(), output.size());
+  }
+}
+
+static void TestVariants() {
+  Wepp::FileCache cache("data", 1 << 20, 1 << 20, 64, std::chrono::milliseconds(0));
+
+  const std::shared_ptr<const Wepp::CachedFile> identity = cache.Get("/app.js");
+  WEPP_CHECK(identity != nullptr);
+  if (!identity) {
+    return;
+  }
+
+  for (const Wepp::ContentEncoding encoding : s_ENCODINGS) {
+    if (!Wepp::CompressionAvailable(encoding)) {
+      continue;
+    }
+
+    const std::shared_ptr<const Wepp::CachedFile> variant = cache.GetVariant(identity, encoding);
+    WEPP_CHECK(variant != nullptr);
+    if (!variant) {
+      continue;
+    }
+
+    WEPP_CHECK(variant->encoding == encoding);
+    WEPP_CHECK(variant->size < identity->size);
+    WEPP_CHECK(variant->contents.size() == variant->size);
+    WEPP_CHECK(variant->etag != identity->etag);
+    WEPP_CHECK(variant->contentType == identity->contentType);
+
+    // Built once, then served from the entry
+    WEPP_CHECK(cache.GetVariant(identity, encoding) == variant);
+  }
+
+  // Already compressed formats are never encoded again
+  const std::shared_ptr<const Wepp::CachedFile> image = cache.Get("/image.png");
+  WEPP_CHECK(image != nullptr);
+  WEPP_CHECK(cache.GetVariant(image, Wepp::ENCODING_GZIP) == nullptr);
+
+  // A precompressed sibling wins over compressing on the fly
+  const std::shared_ptr<const Wepp::CachedFile> style = cache.Get("/style.css");
+  WEPP_CHECK(style != nullptr);
+  const std::shared_ptr<const Wepp::CachedFile> sibling = cache.GetVariant(style, Wepp::ENCODING_GZIP);
+  WEPP_CHECK(sibling != nullptr && sibling->path.filename() == "style.css.gz");
+  WEPP_CHECK(sibling != nullptr && sibling->size < style->size);
+}
+
+// Concurrent first requests for a variant share one build instead of each compressing the file
+static void TestConcurrentVariant() {
+  Wepp::FileCache cache("data", 1 << 20, 1 << 20, 64, std::chrono::milliseconds(0));
+
+  const std::shared_ptr<const Wepp::CachedFile> identity = cache.Get("/app.js");
+  WEPP_CHECK(identity != nullptr);
+  if (!identity || !Wepp::CompressionAvailable(Wepp::ENCODING_BROTLI)) {
+    return;
+  }
+
+  const Wepp::FileCacheStats before = cache.GetStats();
+
+  std::shared_ptr<const Wepp::CachedFile> variants[8];
+  std::vector<std::thread> workers;
+  for (auto &variant : variants) {
+    workers.emplace_back([&cache, &identity, &variant]() { variant = cache.GetVariant(identity, Wepp::ENCODING_BROTLI); });
+  }
+
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+
+  for (const auto &variant : variants) {
+    WEPP_CHECK(variant != nullptr && variant == variants[0]);
+  }
+
+  const Wepp::FileCacheStats after = cache.GetStats();
+  WEPP_CHECK(after.misses - before.misses == 1);
+  WEPP_CHECK(after.hits - before.hits == 7);
+}
+
+static size_t ServedSize(const std::string &_acceptEncoding, std::string &_rawHeaders) {
+  const std::string request = "GET /app.js HTTP/1.1\r\nHost: localhost\r\n" + _acceptEncoding + "\r\n";
+
+  Wepp::RequestView view;
+  WEPP_CHECK(view.Parse((const unsigned char *)request.data(), request.size()));
+
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+  Wepp::HandleWeb(view, builder);
+  WEPP_CHECK(builder.GetStatus() == 200);
+
+  _rawHeaders = builder.GetRawHeaders();
+  return builder.GetBodySize();
+}
+
+// What goes on the wire: the negotiated body must be smaller than the identity one
+static void TestNegotiatedSize() {
+  std::string identityHeaders;
+  const size_t identity = ServedSize("", identityHeaders);
+  WEPP_CHECK(identity == Script().size());
+  WEPP_CHECK(!WeppTest::Contains(identityHeaders, "Content-Encoding"));
+  WEPP_CHECK(WeppTest::Contains(identityHeaders, "Vary: Accept-Encoding"));
+
+  for (const Wepp::ContentEncoding encoding : s_ENCODINGS) {
+    if (!Wepp::CompressionAvailable(encoding)) {
+      continue;
+    }
+
+    const std::string name = Wepp::ContentEncodingName(encoding);
+    std::string headers;
+    const size_t encoded = ServedSize("Accept-Encoding: " + name + "\r\n", headers);
+
+    WEPP_CHECK(WeppTest::Contains(headers, "Content-Encoding: " + name + "\r\n"));
+    WEPP_CHECK(encoded < identity);
+  }
+
+  // Refusing every coding falls back to identity
+  std::string headers;
+  WEPP_CHECK(ServedSize("Accept-Encoding: gzip;q=0, br;q=0\r\n", headers) == identity);
+  WEPP_CHECK(!WeppTest::Contains(headers, "Content-Encoding"));
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+
+  std::filesystem::create_directories("data");
+  std::ofstream("data/app.js") << Script();
+  std::ofstream("data/image.png") << Script();
+  std::ofstream("data/style.css") << std::string(4096, 'a');
+  // Written after the original so it is not considered stale
+  std::ofstream("data/style.css.gz") << "precompressed";
+
+  TestCompress();
+  TestVariants();
+  TestConcurrentVariant();
+  TestNegotiatedSize();
+
+  return WeppTest::Result("CompressionTest");
+}
@@ -0,0 +1,86 @@
+#include "LoopbackServer.hpp"
+#include "TestCommon.hpp"
+#include "Wepp/Server/HTTPChecks.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/Server.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static constexpr size_t s_CLIENTS = 16;
+static constexpr size_t s_REQUESTS_PER_CLIENT = 25;
+
+// Large enough that no response fits in one socket send, so every send is interleaved with other connections
+static std::string Body() {
+  std::string output(256 * 1024, '\0');
+  for (size_t i = 0; i < output.size(); i++) {
+    output[i] = (char)('a' + (i * 31 + i / 4096) % 26);
+  }
+
+  return output;
+}
+
+// Keep-alive clients sharing the workers must each get their own responses intact and in order
+static void TestConcurrentClients(const uint16_t _port, const std::string &_body) {
+  std::atomic<size_t> intact = 0;
+  std::vector<std::thread> clients;
+
+  for (size_t client = 0; client < s_CLIENTS; client++) {
+    clients.emplace_back([&intact, &_body, _port, client]() {
+      const int fd = WeppTest::ConnectLoopback(_port);
+      std::string buffer, head, body;
+
+      for (size_t request = 0; fd >= 0 && request < s_REQUESTS_PER_CLIENT; request++) {
+        const std::string id = std::to_string(client) + '-' + std::to_string(request);
+        if (!WeppTest::SendAll(fd, "GET /" + id + " HTTP/1.1\r\nHost: localhost\r\n\r\n") || !WeppTest::ReadResponse(fd, buffer, head, body)) {
+          break;
+        }
+
+        // The handler echoes the path into a header, which catches responses delivered to the wrong connection
+        if (WeppTest::Contains(head, "HTTP/1.1 200") && WeppTest::Contains(head, "X-Request: /" + id + "\r\n") && body == _body) {
+          intact++;
+        }
+      }
+
+      close(fd);
+    });
+  }
+
+  for (std::thread &client : clients) {
+    client.join();
+  }
+
+  WEPP_CHECK(intact == s_CLIENTS * s_REQUESTS_PER_CLIENT);
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+  WEPP_CHECK(WeppTest::WriteSelfSignedCertificate());
+
+  const std::string body = Body();
+  Wepp::Server server(
+      [&body](const Wepp::RequestView &_req, Wepp::ResponseBuilder &_resp) {
+        _resp.AddHeader("X-Request", std::string(_req.Path()));
+        _resp.SetBody(body);
+        _resp.SetCloseConnection(!Wepp::WantsKeepAlive(_req));
+        _resp.AddHeader("Content-Length", std::to_string(_resp.GetBodySize()));
+        return false;
+      },
+      nullptr, true, 4);
+
+  WeppTest::LoopbackServer loopback(server);
+  WEPP_CHECK(loopback.WaitListening());
+
+  // A client that requests large responses and never reads them keeps its connection stuck on a full socket buffer.
+  // Everyone else must still be served while it waits.
+  const int stalled = WeppTest::ConnectLoopback(loopback.GetPort());
+  WEPP_CHECK(stalled >= 0);
+  WEPP_CHECK(WeppTest::SendAll(stalled, "GET /stalled HTTP/1.1\r\nHost: localhost\r\n\r\nGET /stalled HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+
+  TestConcurrentClients(loopback.GetPort(), body);
+
+  close(stalled);
+  return WeppTest::Result("ConcurrencyTest");
+}
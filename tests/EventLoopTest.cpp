@@ -0,0 +1,86 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/EventLoop.hpp"
+#include <chrono>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+static bool HasEvent(const std::vector<Wepp::Event> &_events, const size_t _count, const uint64_t _token, const uint32_t _flag) {
+  for (size_t i = 0; i < _count; i++) {
+    if (_events[i].token == _token && (_events[i].events & _flag) != 0) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Readiness is reported with the registered token, and one-shot registrations stay quiet until re-armed
+static void TestReadiness(Wepp::EventLoop &_loop) {
+  int sockets[2];
+  WEPP_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+  WEPP_CHECK(Wepp::SetSocketNonBlocking(sockets[0]));
+
+  std::vector<Wepp::Event> events;
+  WEPP_CHECK(_loop.Add(sockets[0], Wepp::EVENT_READ | Wepp::EVENT_ONESHOT, 7));
+  WEPP_CHECK(_loop.Wait(events, 0) == 0);
+
+  WEPP_CHECK(write(sockets[1], "x", 1) == 1);
+  size_t count = _loop.Wait(events, 1000);
+  WEPP_CHECK(HasEvent(events, count, 7, Wepp::EVENT_READ));
+
+  // Still readable, but disarmed until Modify()
+  WEPP_CHECK(_loop.Wait(events, 0) == 0);
+
+  WEPP_CHECK(_loop.Modify(sockets[0], Wepp::EVENT_READ | Wepp::EVENT_WRITE, 8));
+  count = _loop.Wait(events, 1000);
+  WEPP_CHECK(HasEvent(events, count, 8, Wepp::EVENT_READ));
+  WEPP_CHECK(HasEvent(events, count, 8, Wepp::EVENT_WRITE));
+
+  // Removed sockets are never reported again, even while ready
+  WEPP_CHECK(_loop.Remove(sockets[0]));
+  WEPP_CHECK(_loop.Wait(events, 0) == 0);
+
+  // A closed peer is reported as a hang up or a final read
+  WEPP_CHECK(_loop.Add(sockets[0], Wepp::EVENT_READ, 9));
+  char byte;
+  WEPP_CHECK(read(sockets[0], &byte, 1) == 1);
+  WEPP_CHECK(_loop.Wait(events, 0) == 0);
+  close(sockets[1]);
+  count = _loop.Wait(events, 1000);
+  WEPP_CHECK(HasEvent(events, count, 9, Wepp::EVENT_READ | Wepp::EVENT_HUP));
+
+  WEPP_CHECK(_loop.Remove(sockets[0]));
+  close(sockets[0]);
+}
+
+static void TestWake(Wepp::EventLoop &_loop) {
+  std::vector<Wepp::Event> events;
+  const auto started = std::chrono::steady_clock::now();
+
+  std::thread waker([&_loop]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    _loop.Wake();
+  });
+
+  // The wake socket is internal and never shows up as an event
+  WEPP_CHECK(_loop.Wait(events, 10000) == 0);
+  WEPP_CHECK(std::chrono::steady_clock::now() - started < std::chrono::seconds(5));
+
+  waker.join();
+}
+
+int main() {
+  Wepp::EventLoop loop;
+  std::printf("Backend: %s\n", loop.GetBackendName());
+
+#ifdef WEPP_EVENTLOOP_EPOLL
+  WEPP_CHECK(loop.GetBackend() == Wepp::BACKEND_EPOLL);
+#endif // WEPP_EVENTLOOP_EPOLL
+
+  TestReadiness(loop);
+  TestWake(loop);
+
+  return WeppTest::Result("EventLoopTest");
+}
@@ -0,0 +1,69 @@
+#include "TestCommon.hpp"
+#include "Wepp/FileHandling/FileCache.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+static void TestNormalizeURIPath() {
+  const struct {
+    const char *uri;
+    const char *normalized;
+  } accepted[] = {
+      {"/", ""},
+      {"/index.html", "index.html"},
+      {"//assets/./app.js", "assets/app.js"},
+      {"/assets/old/../app.js?v=3#top", "assets/app.js"},
+      {"/a/b/../../c.txt", "c.txt"},
+  };
+
+  for (const auto &test : accepted) {
+    std::string normalized;
+    WEPP_CHECK(Wepp::NormalizeURIPath(test.uri, normalized));
+    WEPP_CHECK(normalized == test.normalized);
+  }
+
+  // Everything that could resolve outside the root, on any platform
+  const char *rejected[] = {
+      "/..",
+      "/../etc/passwd",
+      "/a/../../etc/passwd",
+      "/..\\..\\windows\\win.ini",
+      "/assets\\..\\..\\secret.txt",
+      "/C:/Windows/win.ini",
+      "/C:",
+      "/index.html::$DATA",
+      "/assets/app.js:stream",
+  };
+
+  for (const char *uri : rejected) {
+    std::string normalized;
+    if (Wepp::NormalizeURIPath(uri, normalized)) {
+      std::fprintf(stderr, "Accepted %s as %s\n", uri, normalized.c_str());
+      WEPP_CHECK(false);
+    }
+  }
+}
+
+// Rejected paths never reach the file system, even where the name exists
+static void TestCacheRejects() {
+  std::filesystem::create_directories("root/assets");
+  std::ofstream("root/assets/app.js") << "served";
+  std::ofstream("secret.txt") << "outside the root";
+
+  Wepp::FileCache cache("root", 1 << 20, 1 << 20, 16, std::chrono::milliseconds(0));
+
+  WEPP_CHECK(cache.Get("/assets/app.js") != nullptr);
+  WEPP_CHECK(cache.Get("/assets/../assets/app.js") != nullptr);
+  WEPP_CHECK(cache.Get("/../secret.txt") == nullptr);
+  WEPP_CHECK(cache.Get("/assets\\..\\..\\secret.txt") == nullptr);
+  WEPP_CHECK(cache.Get("/assets/app.js:stream") == nullptr);
+  WEPP_CHECK(cache.Get("/") == nullptr);
+}
+
+int main() {
+  TestNormalizeURIPath();
+  TestCacheRejects();
+
+  return WeppTest::Result("FileCacheTest");
+}
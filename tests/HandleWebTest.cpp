@@ -0,0 +1,119 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/HandlerFunctions.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+struct Exchange {
+  GParsing::HTTPResponse resp;
+  int status;
+  std::string rawHeaders;
+  size_t bodySize;
+};
+
+// HandleWeb serves data/ below the working directory, which ctest sets to this test's own directory
+static void Request(const std::string &_request, Exchange &_exchange) {
+  Wepp::RequestView view;
+  WEPP_CHECK(view.Parse((const unsigned char *)_request.data(), _request.size()));
+
+  Wepp::ResponseBuilder builder(_exchange.resp);
+  Wepp::HandleWeb(view, builder);
+
+  _exchange.status = builder.GetStatus();
+  _exchange.rawHeaders = builder.GetRawHeaders();
+  _exchange.bodySize = builder.GetBodySize();
+}
+
+static std::string ETag(const std::string &_rawHeaders) {
+  const size_t start = _rawHeaders.find("ETag: ");
+  if (start == std::string::npos) {
+    return "";
+  }
+
+  return _rawHeaders.substr(start + 6, _rawHeaders.find("\r\n", start) - start - 6);
+}
+
+static std::string Conditional(const std::string &_method, const std::string &_condition) {
+  return _method + " /page.txt HTTP/1.1\r\nHost: localhost\r\n" + _condition + "\r\n\r\n";
+}
+
+// RFC 9110 13.1.2: a matching If-None-Match is a 304 for GET and HEAD only, other methods get 412
+static void TestIfNoneMatch() {
+  Exchange first;
+  Request("GET /page.txt HTTP/1.1\r\nHost: localhost\r\n\r\n", first);
+  WEPP_CHECK(first.status == 200);
+
+  const std::string etag = ETag(first.rawHeaders);
+  WEPP_CHECK(!etag.empty());
+
+  const struct {
+    const char *method;
+    std::string condition;
+    int status;
+  } cases[] = {
+      {"GET", "If-None-Match: " + etag, 304},
+      {"HEAD", "If-None-Match: *", 304},
+      {"GET", "If-None-Match: \"other\"", 200},
+      {"PUT", "If-None-Match: *", 412},
+      {"POST", "If-None-Match: " + etag, 412},
+      {"DELETE", "If-None-Match: W/" + etag, 412},
+      {"PUT", "If-None-Match: \"other\"", 200},
+      // If-Modified-Since only applies to GET and HEAD
+      {"POST", "If-Modified-Since: Fri, 01 Jan 2100 00:00:00 GMT", 200},
+      {"GET", "If-Modified-Since: Fri, 01 Jan 2100 00:00:00 GMT", 304},
+  };
+
+  for (const auto &test : cases) {
+    Exchange exchange;
+    Request(Conditional(test.method, test.condition), exchange);
+
+    if (exchange.status != test.status) {
+      std::fprintf(stderr, "%s with %s: %d\n", test.method, test.condition.c_str(), exchange.status);
+    }
+
+    WEPP_CHECK(exchange.status == test.status);
+  }
+}
+
+// RFC 9110 14.2: Range only applies to GET, other methods get the whole file even for an unsatisfiable range
+static void TestRangeMethods() {
+  const struct {
+    const char *method;
+    const char *range;
+    int status;
+  } cases[] = {
+      {"GET", "bytes=0-3", 206},
+      {"GET", "bytes=1000-2000", 416},
+      {"HEAD", "bytes=0-3", 200},
+      {"HEAD", "bytes=1000-2000", 200},
+      {"POST", "bytes=1000-2000", 200},
+      {"PUT", "bytes=0-3", 200},
+  };
+
+  for (const auto &test : cases) {
+    Exchange exchange;
+    Request(Conditional(test.method, std::string("Range: ") + test.range), exchange);
+
+    if (exchange.status != test.status) {
+      std::fprintf(stderr, "%s with Range: %s: %d\n", test.method, test.range, exchange.status);
+    }
+
+    WEPP_CHECK(exchange.status == test.status);
+
+    if (test.status == 200) {
+      WEPP_CHECK(exchange.bodySize == 20);
+    }
+  }
+}
+
+int main() {
+  std::filesystem::create_directories("data");
+  std::ofstream("data/page.txt") << "conditional requests";
+
+  TestIfNoneMatch();
+  TestRangeMethods();
+
+  return WeppTest::Result("HandleWebTest");
+}
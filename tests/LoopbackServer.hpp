@@ -0,0 +1,178 @@
+#pragma once
+#include "Wepp/Server/Server.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+namespace WeppTest {
+// The server loads ssl.crt.pem and ssl.key.pem from the working directory, even when only plain HTTP is used
+inline bool WriteSelfSignedCertificate() {
+  EVP_PKEY *key = nullptr;
+  EVP_PKEY_CTX *keyCTX = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, nullptr);
+  const bool generated = keyCTX && EVP_PKEY_keygen_init(keyCTX) == 1 && EVP_PKEY_keygen(keyCTX, &key) == 1;
+  EVP_PKEY_CTX_free(keyCTX);
+
+  if (!generated) {
+    return false;
+  }
+
+  X509 *certificate = X509_new();
+  X509_set_version(certificate, 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+  X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+  X509_gmtime_adj(X509_getm_notAfter(certificate), 3600);
+  X509_set_pubkey(certificate, key);
+  X509_NAME_add_entry_by_txt(X509_get_subject_name(certificate), "CN", MBSTRING_ASC, (const unsigned char *)"localhost", -1, -1, 0);
+  X509_set_issuer_name(certificate, X509_get_subject_name(certificate));
+
+  // Ed25519 signs without a separate digest
+  bool output = X509_sign(certificate, key, nullptr) > 0;
+
+  FILE *file = std::fopen("ssl.crt.pem", "w");
+  output = output && file && PEM_write_X509(file, certificate) == 1;
+  if (file) {
+    std::fclose(file);
+  }
+
+  file = std::fopen("ssl.key.pem", "w");
+  output = output && file && PEM_write_PrivateKey(file, key, nullptr, nullptr, 0, nullptr, nullptr) == 1;
+  if (file) {
+    std::fclose(file);
+  }
+
+  X509_free(certificate);
+  EVP_PKEY_free(key);
+  return output;
+}
+
+// Bound and released again, so the server can take it. Another process could race for it, which is fine for a test.
+inline uint16_t FreePort() {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t length = sizeof(address);
+
+  bind(fd, (sockaddr *)&address, sizeof(address));
+  getsockname(fd, (sockaddr *)&address, &length);
+  close(fd);
+  return ntohs(address.sin_port);
+}
+
+// Blocking socket with Nagle disabled, -1 on failure
+inline int ConnectLoopback(const uint16_t _port) {
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(_port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (connect(fd, (sockaddr *)&address, sizeof(address)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  const int noDelay = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+  return fd;
+}
+
+inline bool SendAll(const int _fd, const std::string &_data) {
+  size_t sent = 0;
+  while (sent < _data.size()) {
+    const ssize_t output = send(_fd, _data.data() + sent, _data.size() - sent, MSG_NOSIGNAL);
+    if (output <= 0) {
+      return false;
+    }
+
+    sent += output;
+  }
+
+  return true;
+}
+
+// Reads one response framed by Content-Length. Bytes past it stay in _buffer for the next call.
+// Responses to HEAD carry a Content-Length but no body, pass _bodyless for those.
+inline bool ReadResponse(const int _fd, std::string &_buffer, std::string &_head, std::string &_body, const bool _bodyless = false) {
+  char chunk[65536];
+  size_t headEnd;
+
+  while ((headEnd = _buffer.find("\r\n\r\n")) == std::string::npos) {
+    const ssize_t output = recv(_fd, chunk, sizeof(chunk), 0);
+    if (output <= 0) {
+      return false;
+    }
+
+    _buffer.append(chunk, output);
+  }
+
+  _head = _buffer.substr(0, headEnd + 4);
+  const size_t lengthStart = _head.find("Content-Length: ");
+  const size_t length = lengthStart == std::string::npos || _bodyless ? 0 : std::strtoull(_head.c_str() + lengthStart + 16, nullptr, 10);
+
+  while (_buffer.size() < headEnd + 4 + length) {
+    const ssize_t output = recv(_fd, chunk, sizeof(chunk), 0);
+    if (output <= 0) {
+      return false;
+    }
+
+    _buffer.append(chunk, output);
+  }
+
+  _body = _buffer.substr(headEnd + 4, length);
+  _buffer.erase(0, headEnd + 4 + length);
+  return true;
+}
+
+// Runs a Server on a free loopback port on its own thread, stopped again on destruction
+class LoopbackServer {
+private:
+  Wepp::Server &m_server;
+  const uint16_t m_PORT;
+  std::atomic<bool> m_close;
+  std::thread m_thread;
+
+public:
+  explicit LoopbackServer(Wepp::Server &_server) : m_server(_server), m_PORT(FreePort()), m_close(false) {
+    m_thread = std::thread([this]() { m_server.Run("127.0.0.1", m_PORT, m_close); });
+  }
+
+  LoopbackServer(LoopbackServer &&) = delete;
+  LoopbackServer(const LoopbackServer &) = delete;
+  LoopbackServer &operator=(LoopbackServer &&) = delete;
+  LoopbackServer &operator=(const LoopbackServer &) = delete;
+
+  ~LoopbackServer() {
+    m_close = true;
+    m_thread.join();
+  }
+
+  // Waits up to two seconds for the listener to accept connections
+  bool WaitListening() {
+    for (int attempt = 0; attempt < 100; attempt++) {
+      const int fd = ConnectLoopback(m_PORT);
+      if (fd >= 0) {
+        close(fd);
+        return true;
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+
+    return false;
+  }
+
+  uint16_t GetPort() const { return m_PORT; }
+};
+} // namespace WeppTest
@@ -0,0 +1,96 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/Metrics.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Every value lands in the bucket whose range holds it, within the promised 25% relative error
+static void TestBuckets() {
+  uint64_t previousLimit = 0;
+  for (size_t index = 0; index < Wepp::LatencyHistogram::s_BUCKET_COUNT; index++) {
+    const uint64_t limit = Wepp::LatencyHistogram::BucketLimit(index);
+    WEPP_CHECK(limit > previousLimit);
+    previousLimit = limit;
+  }
+
+  for (uint64_t micros = 0; micros < (uint64_t)1 << 26; micros = micros * 9 / 8 + 1) {
+    const size_t index = Wepp::LatencyHistogram::BucketIndex(micros);
+    const uint64_t upper = Wepp::LatencyHistogram::BucketLimit(index);
+    const uint64_t lower = index == 0 ? 0 : Wepp::LatencyHistogram::BucketLimit(index - 1);
+
+    WEPP_CHECK(lower <= micros && micros < upper);
+    // Below s_SUB_BUCKETS every microsecond has its own bucket
+    WEPP_CHECK(micros < Wepp::LatencyHistogram::s_SUB_BUCKETS ? upper - lower == 1 : (upper - lower) * 4 <= upper);
+  }
+
+  // Beyond the last exponent everything shares the open ended bucket
+  WEPP_CHECK(Wepp::LatencyHistogram::BucketIndex(UINT64_MAX) == Wepp::LatencyHistogram::s_BUCKET_COUNT - 1);
+}
+
+// Shards of threads that already exited still count
+static void TestThreads() {
+  const Wepp::MetricsSnapshot before = Wepp::GetMetrics();
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; i++) {
+    threads.emplace_back([]() {
+      for (int j = 0; j < 1000; j++) {
+        Wepp::CountMetric(Wepp::COUNTER_REQUESTS);
+        Wepp::CountMetric(Wepp::COUNTER_BYTES_SENT, 100);
+        Wepp::RecordLatency(Wepp::PHASE_HANDLER, std::chrono::microseconds(j));
+      }
+    });
+  }
+
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  const Wepp::MetricsSnapshot after = Wepp::GetMetrics();
+  WEPP_CHECK(after.counters[Wepp::COUNTER_REQUESTS] - before.counters[Wepp::COUNTER_REQUESTS] == 8000);
+  WEPP_CHECK(after.counters[Wepp::COUNTER_BYTES_SENT] - before.counters[Wepp::COUNTER_BYTES_SENT] == 800000);
+
+  const Wepp::LatencyHistogram &histogram = after.phases[Wepp::PHASE_HANDLER];
+  WEPP_CHECK(histogram.count - before.phases[Wepp::PHASE_HANDLER].count == 8000);
+  WEPP_CHECK(histogram.sumMicros - before.phases[Wepp::PHASE_HANDLER].sumMicros == 8 * 999 * 1000 / 2);
+
+  uint64_t total = 0;
+  for (const uint64_t bucket : histogram.buckets) {
+    total += bucket;
+  }
+
+  WEPP_CHECK(total == histogram.count);
+}
+
+static void TestRender() {
+  Wepp::CountMetric(Wepp::COUNTER_CONNECTIONS_ACCEPTED, 3);
+  Wepp::CountMetric(Wepp::COUNTER_CONNECTIONS_CLOSED, 1);
+  // Negative durations from clock misuse are clamped rather than wrapping around
+  Wepp::RecordLatency(Wepp::PHASE_SEND, std::chrono::microseconds(-5));
+  Wepp::RecordLatency(Wepp::PHASE_SEND, std::chrono::seconds(100));
+
+  const Wepp::MetricsSnapshot metrics = Wepp::GetMetrics();
+  std::string text;
+  Wepp::RenderMetrics(text);
+
+  WEPP_CHECK(WeppTest::Contains(text, "# TYPE wepp_requests_total counter\nwepp_requests_total " + std::to_string(metrics.counters[Wepp::COUNTER_REQUESTS]) + "\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_connections_active 2\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "# TYPE wepp_phase_duration_seconds histogram\n"));
+
+  // Cumulative: the first send bucket holds the clamped sample, +Inf holds both
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_phase_duration_seconds_bucket{phase=\"send\",le=\"1e-06\"} 1\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_phase_duration_seconds_bucket{phase=\"send\",le=\"+Inf\"} 2\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_phase_duration_seconds_sum{phase=\"send\"} 100.000000\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_phase_duration_seconds_count{phase=\"send\"} 2\n"));
+  WEPP_CHECK(WeppTest::Contains(text, "wepp_phase_duration_seconds_count{phase=\"handler\"} 8000\n"));
+}
+
+int main() {
+  TestBuckets();
+  TestThreads();
+  TestRender();
+
+  return WeppTest::Result("MetricsTest");
+}
@@ -0,0 +1,73 @@
+#include "LoopbackServer.hpp"
+#include "TestCommon.hpp"
+#include "Wepp/Server/HandlerFunctions.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/Server.hpp"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/time.h>
+#include <unistd.h>
+
+static const std::string s_SMALL = "pipelined contents";
+
+static std::string Request(const std::string &_method, const std::string &_path) {
+  return _method + ' ' + _path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+}
+
+// HEAD, GET and GET again in one write. Any body on the HEAD response would be read as the start of the next one.
+static void TestHeadThenGet(const uint16_t _port, const std::string &_path, const std::string &_contents) {
+  const int fd = WeppTest::ConnectLoopback(_port);
+  WEPP_CHECK(fd >= 0);
+
+  // A HEAD response with a body leaves the stream misaligned, which would otherwise hang the last read
+  const timeval timeout = {5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  WEPP_CHECK(WeppTest::SendAll(fd, Request("HEAD", _path) + Request("GET", _path) + Request("HEAD", _path)));
+
+  std::string buffer, head, body;
+  WEPP_CHECK(WeppTest::ReadResponse(fd, buffer, head, body, true));
+  WEPP_CHECK(head.compare(0, 13, "HTTP/1.1 200 ") == 0);
+  WEPP_CHECK(WeppTest::Contains(head, "Content-Length: " + std::to_string(_contents.size()) + "\r\n"));
+
+  WEPP_CHECK(WeppTest::ReadResponse(fd, buffer, head, body));
+  WEPP_CHECK(head.compare(0, 13, "HTTP/1.1 200 ") == 0);
+  WEPP_CHECK(body == _contents);
+
+  WEPP_CHECK(WeppTest::ReadResponse(fd, buffer, head, body, true));
+  WEPP_CHECK(head.compare(0, 13, "HTTP/1.1 200 ") == 0);
+  WEPP_CHECK(WeppTest::Contains(head, "Content-Length: " + std::to_string(_contents.size()) + "\r\n"));
+
+  // Nothing may follow the last HEAD response
+  const timeval shortTimeout = {0, 200 * 1000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &shortTimeout, sizeof(shortTimeout));
+  char extra;
+  WEPP_CHECK(buffer.empty() && recv(fd, &extra, 1, 0) < 0);
+
+  close(fd);
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+  WEPP_CHECK(WeppTest::WriteSelfSignedCertificate());
+
+  // Small files are served from memory, large ones are streamed from the cached descriptor
+  std::string large(3 * 1024 * 1024, '\0');
+  for (size_t i = 0; i < large.size(); i++) {
+    large[i] = (char)('a' + i % 26);
+  }
+
+  std::filesystem::create_directories("data");
+  std::ofstream("data/small.txt") << s_SMALL;
+  std::ofstream("data/large.bin", std::ios::binary) << large;
+
+  Wepp::Server server(Wepp::HandleWeb, nullptr, true, 2);
+  WeppTest::LoopbackServer loopback(server);
+  WEPP_CHECK(loopback.WaitListening());
+
+  TestHeadThenGet(loopback.GetPort(), "/small.txt", s_SMALL);
+  TestHeadThenGet(loopback.GetPort(), "/large.bin", large);
+
+  return WeppTest::Result("PipelineTest");
+}
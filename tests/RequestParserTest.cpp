@@ -0,0 +1,122 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/RequestParser.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static constexpr size_t s_MAX_HEADER_SIZE = 64 * 1024;
+static constexpr uint64_t s_MAX_BODY_SIZE = 1024 * 1024;
+
+static const std::string s_CHUNKED = "POST /upload HTTP/1.1\r\nHost: localhost\r\nTransfer-Encoding: chunked\r\nX-After: kept\r\n\r\n"
+                                     "5;ext=1\r\nhello\r\n6\r\n world\r\n0\r\nX-Trailer: dropped\r\n\r\n";
+static const std::string s_NEXT = "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+// Feeds _input in pieces of _step bytes, the way reads arrive
+static Wepp::ParseStatus Feed(Wepp::RequestParser &_parser, std::vector<unsigned char> &_buffer, const std::string &_input, const size_t _step) {
+  Wepp::ParseStatus status = Wepp::PARSE_INCOMPLETE;
+
+  for (size_t offset = 0; offset < _input.size() && status == Wepp::PARSE_INCOMPLETE; offset += _step) {
+    const size_t size = std::min(_step, _input.size() - offset);
+    _buffer.insert(_buffer.end(), _input.begin() + offset, _input.begin() + offset + size);
+    status = _parser.Parse(_buffer, s_MAX_HEADER_SIZE, s_MAX_BODY_SIZE);
+  }
+
+  return status;
+}
+
+// A decoded request reads like one sent with Content-Length, whatever the read boundaries were
+static void TestChunkedBecomesContentLength() {
+  for (const size_t step : {(size_t)1, (size_t)7, s_CHUNKED.size() + s_NEXT.size()}) {
+    Wepp::RequestParser parser;
+    std::vector<unsigned char> buffer;
+
+    WEPP_CHECK(Feed(parser, buffer, s_CHUNKED + s_NEXT, step) == Wepp::PARSE_COMPLETE);
+
+    Wepp::RequestView view;
+    WEPP_CHECK(view.Parse(buffer.data(), parser.RequestSize()));
+    WEPP_CHECK(view.Body() == "hello world");
+    WEPP_CHECK(view.Find("Transfer-Encoding").empty());
+    WEPP_CHECK(view.Find("Content-Length") == "11");
+    WEPP_CHECK(view.Find("X-After") == "kept");
+    WEPP_CHECK(view.Find("X-Trailer").empty());
+
+    // The pipelined request behind it is untouched
+    const size_t consumed = parser.ConsumedSize();
+    WEPP_CHECK(consumed <= buffer.size());
+
+    if (consumed <= buffer.size()) {
+      WEPP_CHECK(std::string(buffer.begin() + consumed, buffer.end()) == s_NEXT.substr(0, buffer.size() - consumed));
+    }
+  }
+}
+
+static void TestEmptyChunkedBody() {
+  Wepp::RequestParser parser;
+  std::vector<unsigned char> buffer;
+
+  WEPP_CHECK(Feed(parser, buffer, "POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", 1024) == Wepp::PARSE_COMPLETE);
+
+  Wepp::RequestView view;
+  WEPP_CHECK(view.Parse(buffer.data(), parser.RequestSize()));
+  WEPP_CHECK(view.Body().empty());
+  WEPP_CHECK(view.Find("Content-Length") == "0");
+  WEPP_CHECK(parser.ConsumedSize() == buffer.size());
+}
+
+static void TestRefusedCodings() {
+  const struct {
+    const char *request;
+    int status;
+  } cases[] = {
+      {"POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: gzip, chunked\r\n\r\n0\r\n\r\n", 501},
+      {"POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: gzip\r\n\r\n", 501},
+      {"POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", 400},
+      {"POST / HTTP/1.1\r\nHost: x\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", 400},
+      {"POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n", 400},
+  };
+
+  for (const auto &test : cases) {
+    Wepp::RequestParser parser;
+    std::vector<unsigned char> buffer;
+
+    WEPP_CHECK(Feed(parser, buffer, test.request, 1024) == Wepp::PARSE_ERROR);
+    WEPP_CHECK(parser.ErrorStatus() == test.status);
+  }
+}
+
+// Only whitespace before an extension or the CRLF may follow the chunk size digits
+static void TestChunkSizeLine() {
+  const std::string head = "POST / HTTP/1.1\r\nHost: x\r\nTransfer-Encoding: chunked\r\n\r\n";
+  const struct {
+    const char *body;
+    Wepp::ParseStatus status;
+  } cases[] = {
+      {"5\r\nhello\r\n0\r\n\r\n", Wepp::PARSE_COMPLETE},
+      {"5;name=value\r\nhello\r\n0\r\n\r\n", Wepp::PARSE_COMPLETE},
+      {"5 \t;name\r\nhello\r\n0 \r\n\r\n", Wepp::PARSE_COMPLETE},
+      {"5zz\r\nhello\r\n0\r\n\r\n", Wepp::PARSE_ERROR},
+      {"5 z\r\nhello\r\n0\r\n\r\n", Wepp::PARSE_ERROR},
+      {"5\nhello\r\n0\r\n\r\n", Wepp::PARSE_ERROR},
+      {"5\r\nhello\r\n0x\r\n\r\n", Wepp::PARSE_ERROR},
+  };
+
+  for (const auto &test : cases) {
+    Wepp::RequestParser parser;
+    std::vector<unsigned char> buffer;
+
+    WEPP_CHECK(Feed(parser, buffer, head + test.body, 1024) == test.status);
+    if (test.status == Wepp::PARSE_ERROR) {
+      WEPP_CHECK(parser.ErrorStatus() == 400);
+    }
+  }
+}
+
+int main() {
+  TestChunkedBecomesContentLength();
+  TestEmptyChunkedBody();
+  TestRefusedCodings();
+  TestChunkSizeLine();
+
+  return WeppTest::Result("RequestParserTest");
+}
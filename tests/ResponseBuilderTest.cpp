@@ -0,0 +1,106 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/RequestHandler.hpp"
+#include "Wepp/Server/RequestView.hpp"
+#include "Wepp/Server/ResponseBuilder.hpp"
+#include "Wepp/Server/ResponseWriter.hpp"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+static const std::string s_REQUEST = "GET /file HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static std::string Head(const GParsing::HTTPResponse &_resp) {
+  std::vector<unsigned char> buffer;
+  Wepp::AppendResponseHead(_resp, buffer);
+  return std::string(buffer.begin(), buffer.end());
+}
+
+static bool LegacyHandler(GParsing::HTTPRequest, GParsing::HTTPResponse &_resp, bool &_closeConnection) {
+  _resp.headers.push_back({"X-Wepp-File", {"/etc/passwd"}});
+  _resp.message = {'o', 'k'};
+  _closeConnection = true;
+  return false;
+}
+
+// A header named like the old file body marker is an ordinary header, never a file to stream
+static void TestHandlerHeaderIsPlain() {
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+  Wepp::FileBody body;
+
+  builder.AddHeader("X-Wepp-File", "/etc/passwd");
+  builder.SetBody(std::string_view("ok"));
+
+  WEPP_CHECK(!builder.TakeFileBody(body));
+  WEPP_CHECK(WeppTest::Contains(Head(resp), "\r\nX-Wepp-File: /etc/passwd\r\n"));
+  WEPP_CHECK(builder.GetBodySize() == 2);
+}
+
+static void TestLegacyHandlerHeaderIsPlain() {
+  Wepp::RequestView request;
+  WEPP_CHECK(request.Parse((const unsigned char *)s_REQUEST.data(), s_REQUEST.size()));
+
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+  Wepp::FileBody body;
+
+  Wepp::AdaptHandler(LegacyHandler)(request, builder);
+
+  WEPP_CHECK(!builder.TakeFileBody(body));
+  WEPP_CHECK(WeppTest::Contains(Head(resp), "\r\nX-Wepp-File: /etc/passwd\r\n"));
+}
+
+static void TestFileBodyRanges() {
+  std::FILE *file = std::fopen("body.txt", "wb");
+  std::fputs("0123456789", file);
+  std::fclose(file);
+
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+  Wepp::FileBody body;
+
+  builder.SetFileBody(std::make_shared<const Wepp::FileHandle>(Wepp::OpenFileDescriptor("body.txt")));
+  builder.SetRangeBody(10, {{2, 4}}, "text/plain");
+
+  WEPP_CHECK(builder.GetStatus() == 206);
+  WEPP_CHECK(WeppTest::Contains(Head(resp), "\r\nContent-Range: bytes 2-4/10\r\n"));
+  WEPP_CHECK(builder.TakeFileBody(body));
+  WEPP_CHECK(body.file && body.file->Get() >= 0);
+  WEPP_CHECK(body.parts.size() == 1 && body.parts[0].offset == 2 && body.parts[0].length == 3);
+
+  // Taken once
+  WEPP_CHECK(!builder.TakeFileBody(body));
+
+  // A later in-memory body replaces the file
+  builder.SetFileBody(body.file);
+  builder.SetBody(std::string_view("memory"));
+  WEPP_CHECK(!builder.TakeFileBody(body));
+}
+
+// Pre-rendered lines come only from the builder, a header with the old marker name is escaped like any other
+static void TestRawHeaders() {
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+
+  builder.AddHeader("X-Wepp-Raw", "Injected: yes");
+  builder.AddRawHeaders("ETag: \"1\"\r\n");
+  builder.AddRawHeaders("Cache-Control: no-cache\r\n");
+
+  std::vector<unsigned char> buffer;
+  Wepp::AppendResponseHead(resp, buffer, builder.GetRawHeaders());
+  const std::string head(buffer.begin(), buffer.end());
+
+  WEPP_CHECK(head == "HTTP/1.1 200 OK\r\nETag: \"1\"\r\nCache-Control: no-cache\r\nX-Wepp-Raw: Injected: yes\r\n\r\n");
+  WEPP_CHECK(Wepp::ResponseHeadSize(resp, builder.GetRawHeaders()) == head.size());
+  WEPP_CHECK(!WeppTest::Contains(Head(resp), "ETag"));
+}
+
+int main() {
+  TestHandlerHeaderIsPlain();
+  TestLegacyHandlerHeaderIsPlain();
+  TestFileBodyRanges();
+  TestRawHeaders();
+
+  return WeppTest::Result("ResponseBuilderTest");
+}
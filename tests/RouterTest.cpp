@@ -0,0 +1,137 @@
+#include "TestCommon.hpp"
+#include "Wepp/Server/Router.hpp"
+#include <stdexcept>
+#include <string>
+
+static constexpr size_t s_ROUTE_COUNT = 1000;
+
+struct Match {
+  int route;
+  std::string parameter;
+};
+
+// Status, the matched route (-1 for none) and its first parameter
+static int Dispatch(const Wepp::Router &_router, const std::string &_method, const std::string &_path, Match &_match, std::string *_head = nullptr) {
+  const std::string request = _method + " " + _path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  Wepp::RequestView view;
+  WEPP_CHECK(view.Parse((const unsigned char *)request.data(), request.size()));
+
+  GParsing::HTTPResponse resp;
+  Wepp::ResponseBuilder builder(resp);
+  _match = {-1, ""};
+
+  // Handlers report what they matched through the body
+  _router.Dispatch(view, builder);
+
+  const std::string body(resp.message.begin(), resp.message.end());
+  const size_t separator = body.find('|');
+  if (separator != std::string::npos) {
+    _match.route = std::stoi(body.substr(0, separator));
+    _match.parameter = body.substr(separator + 1);
+  }
+
+  if (_head) {
+    for (const auto &header : resp.headers) {
+      *_head += header.first + ": " + header.second[0] + "\r\n";
+    }
+  }
+
+  return builder.GetStatus();
+}
+
+static Wepp::WEPP_ROUTE_HANDLER Reporting(const int _route, const char *_parameter) {
+  return [_route, _parameter](const Wepp::RequestView &, const Wepp::RouteParameters &_parameters, Wepp::ResponseBuilder &_resp) {
+    _resp.SetBody(std::to_string(_route) + "|" + std::string(_parameters.Get(_parameter)));
+    return false;
+  };
+}
+
+// Every one of a thousand routes is reached, with its parameter, and nothing else is
+static void TestThousandRoutes() {
+  Wepp::Router router;
+
+  for (size_t i = 0; i < s_ROUTE_COUNT; i++) {
+    const std::string prefix = "/api/v1/resource" + std::to_string(i);
+    router.Add(GParsing::GPARSING_GET, prefix + "/:id", Reporting((int)i, "id"));
+    router.Add(GParsing::GPARSING_GET, prefix + "/list", Reporting((int)(s_ROUTE_COUNT + i), "id"));
+  }
+
+  router.Compile();
+
+  for (size_t i = 0; i < s_ROUTE_COUNT; i++) {
+    const std::string prefix = "/api/v1/resource" + std::to_string(i);
+    Match match;
+
+    WEPP_CHECK(Dispatch(router, "GET", prefix + "/42?full=1", match) == 200);
+    WEPP_CHECK(match.route == (int)i && match.parameter == "42");
+
+    WEPP_CHECK(Dispatch(router, "GET", prefix + "/list", match) == 200);
+    WEPP_CHECK(match.route == (int)(s_ROUTE_COUNT + i));
+  }
+
+  Match match;
+  WEPP_CHECK(Dispatch(router, "GET", "/api/v1/resource1000/1", match) == 404 && match.route == -1);
+  WEPP_CHECK(Dispatch(router, "GET", "/api/v1/resource1/", match) == 404);
+  WEPP_CHECK(Dispatch(router, "GET", "/api/v1/resource1/1/extra", match) == 404);
+}
+
+// Static text beats parameters, which beat wildcards
+static void TestPrecedence() {
+  Wepp::Router router;
+  router.Add(GParsing::GPARSING_UNKNOWN, "/files/*rest", Reporting(0, "rest"));
+  router.Add(GParsing::GPARSING_UNKNOWN, "/files/:name", Reporting(1, "name"));
+  router.Add(GParsing::GPARSING_UNKNOWN, "/files/readme", Reporting(2, "name"));
+  router.Compile();
+
+  Match match;
+  Dispatch(router, "GET", "/files/readme", match);
+  WEPP_CHECK(match.route == 2);
+
+  Dispatch(router, "GET", "/files/notes", match);
+  WEPP_CHECK(match.route == 1 && match.parameter == "notes");
+
+  Dispatch(router, "GET", "/files/a/b/c", match);
+  WEPP_CHECK(match.route == 0 && match.parameter == "a/b/c");
+}
+
+static void TestMethods() {
+  Wepp::Router router;
+  router.Add(GParsing::GPARSING_GET, "/items/:id", Reporting(0, "id"));
+  router.Add(GParsing::GPARSING_DELETE, "/items/:id", Reporting(1, "id"));
+  router.Compile();
+
+  Match match;
+  WEPP_CHECK(Dispatch(router, "DELETE", "/items/7", match) == 200 && match.route == 1);
+
+  std::string head;
+  WEPP_CHECK(Dispatch(router, "POST", "/items/7", match, &head) == 405);
+  WEPP_CHECK(WeppTest::Contains(head, "Allow: GET, DELETE\r\n"));
+}
+
+static void TestInvalidRoutes() {
+  Wepp::Router router;
+  router.Add(GParsing::GPARSING_GET, "/users/:id", Reporting(0, "id"));
+
+  const char *invalid[] = {"users", "/users/:id", "/users/:name/posts", "/files/*rest/more", "/x/:"};
+
+  for (const char *pattern : invalid) {
+    bool threw = false;
+
+    try {
+      router.Add(GParsing::GPARSING_GET, pattern, Reporting(1, "id"));
+    } catch (const std::runtime_error &) {
+      threw = true;
+    }
+
+    WEPP_CHECK(threw);
+  }
+}
+
+int main() {
+  TestThousandRoutes();
+  TestPrecedence();
+  TestMethods();
+  TestInvalidRoutes();
+
+  return WeppTest::Result("RouterTest");
+}
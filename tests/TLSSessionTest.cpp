@@ -0,0 +1,115 @@
+#include "LoopbackServer.hpp"
+#include "TestCommon.hpp"
+#include "Wepp/Server/Logging.hpp"
+#include "Wepp/Server/Server.hpp"
+#include <string>
+#include <unistd.h>
+
+struct Connection {
+  bool reused;
+  std::string response;
+  // Owned by the caller, offered on the next connection
+  SSL_SESSION *session;
+};
+
+// One request per connection. Reading until the server closes also takes in TLS 1.3 tickets sent after the handshake.
+static bool Exchange(SSL_CTX *_clientCTX, const uint16_t _port, SSL_SESSION *_session, Connection &_connection) {
+  const int fd = WeppTest::ConnectLoopback(_port);
+  if (fd < 0) {
+    return false;
+  }
+
+  SSL *ssl = SSL_new(_clientCTX);
+  SSL_set_fd(ssl, fd);
+  if (_session) {
+    SSL_set_session(ssl, _session);
+  }
+
+  bool output = SSL_connect(ssl) == 1;
+  if (output) {
+    const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    output = SSL_write(ssl, request.data(), (int)request.size()) == (int)request.size();
+
+    char buffer[4096];
+    int read;
+    while (output && (read = SSL_read(ssl, buffer, sizeof(buffer))) > 0) {
+      _connection.response.append(buffer, read);
+    }
+
+    _connection.reused = SSL_session_reused(ssl) == 1;
+    _connection.session = SSL_get1_session(ssl);
+    SSL_shutdown(ssl);
+  }
+
+  SSL_free(ssl);
+  close(fd);
+  return output;
+}
+
+// A first connection does a full handshake, a second one offering its session resumes it
+static void TestResumption(const char *_name, Wepp::Server &_server, const uint16_t _port, const int _maxVersion, const bool _tickets) {
+  SSL_CTX *clientCTX = SSL_CTX_new(TLS_client_method());
+  SSL_CTX_set_verify(clientCTX, SSL_VERIFY_NONE, nullptr);
+  SSL_CTX_set_max_proto_version(clientCTX, _maxVersion);
+  if (!_tickets) {
+    SSL_CTX_set_options(clientCTX, SSL_OP_NO_TICKET);
+  }
+
+  const Wepp::TLSSessionStats before = _server.GetTLSSessionStats();
+
+  Connection first = {};
+  WEPP_CHECK(Exchange(clientCTX, _port, nullptr, first));
+  WEPP_CHECK(!first.reused);
+  WEPP_CHECK(WeppTest::Contains(first.response, "HTTP/1.1 200") && WeppTest::Contains(first.response, "resumable"));
+
+  Connection second = {};
+  WEPP_CHECK(first.session && Exchange(clientCTX, _port, first.session, second));
+  WEPP_CHECK(second.reused);
+  WEPP_CHECK(WeppTest::Contains(second.response, "resumable"));
+
+  const Wepp::TLSSessionStats after = _server.GetTLSSessionStats();
+  const uint64_t full = after.fullHandshakes - before.fullHandshakes;
+  const uint64_t resumed = after.resumedHandshakes - before.resumedHandshakes;
+  std::printf("%s: %llu full, %llu resumed\n", _name, (unsigned long long)full, (unsigned long long)resumed);
+
+  WEPP_CHECK(full == 1);
+  WEPP_CHECK(resumed == 1);
+
+  if (_tickets) {
+    WEPP_CHECK(after.ticketsIssued > before.ticketsIssued);
+    WEPP_CHECK(after.ticketsAccepted - before.ticketsAccepted == 1);
+  } else {
+    // Without tickets the session comes back from the server's session ID cache
+    WEPP_CHECK(after.cacheHits - before.cacheHits == 1);
+  }
+
+  SSL_SESSION_free(first.session);
+  SSL_SESSION_free(second.session);
+  SSL_CTX_free(clientCTX);
+}
+
+int main() {
+  Wepp::SetLogLevel(GLog::LOG_WARNING);
+
+  WEPP_CHECK(WeppTest::WriteSelfSignedCertificate());
+
+  Wepp::Server server(
+      [](const Wepp::RequestView &, Wepp::ResponseBuilder &_resp) {
+        _resp.SetBody(std::string_view("resumable"));
+        _resp.AddHeader("Content-Length", std::to_string(_resp.GetBodySize()));
+        return false;
+      },
+      nullptr, false, 2);
+
+  WeppTest::LoopbackServer loopback(server);
+  const bool listening = loopback.WaitListening();
+
+  WEPP_CHECK(listening);
+  if (listening) {
+    TestResumption("TLS 1.3 tickets", server, loopback.GetPort(), TLS1_3_VERSION, true);
+    TestResumption("TLS 1.2 tickets", server, loopback.GetPort(), TLS1_2_VERSION, true);
+    TestResumption("TLS 1.2 session ID", server, loopback.GetPort(), TLS1_2_VERSION, false);
+  }
+
+  return WeppTest::Result("TLSSessionTest");
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdio>
+#include <string>
+
+namespace WeppTest {
+inline int &Failures() {
+  static int failures = 0;
+  return failures;
+}
+
+inline void Check(const bool _passed, const char *_expression, const char *_file, const int _line) {
+  if (!_passed) {
+    std::fprintf(stderr, "%s:%d: check failed: %s\n", _file, _line, _expression);
+    Failures()++;
+  }
+}
+
+// Exit code for main()
+inline int Result(const char *_name) {
+  std::printf("%s: %s\n", _name, Failures() == 0 ? "passed" : "FAILED");
+  return Failures() == 0 ? 0 : 1;
+}
+
+inline bool Contains(const std::string &_text, const std::string &_part) {
+  return _text.find(_part) != std::string::npos;
+}
+} // namespace WeppTest
+
+// Keeps going after a failure so one run reports every broken check
+#define WEPP_CHECK(expression) WeppTest::Check((expression), #expression, __FILE__, __LINE__)